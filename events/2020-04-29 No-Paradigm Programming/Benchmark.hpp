@@ -0,0 +1,2351 @@
+/**************************************************************************************************
+*
+* \file Benchmark.hpp
+* \brief C++ Training - Benchmark harness shared by the design pattern benchmarks
+*
+* Copyright (C) 2015-2020 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "CodeSize.hpp"
+#include "Lazy.hpp"
+#include "Parallel.hpp"
+#include "Pipeline.hpp"
+#include "PerfCounters.hpp"
+#include "Results.hpp"
+#include "ShapeTypes.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#  include <malloc.h>
+#endif
+
+
+namespace benchmark {
+
+   //**********************************************************************************************
+   // Runs a kernel for a number of untimed warm-up iterations followed by a number of timed
+   // repetitions. Every repetition is timed individually and contributes one sample. If a set of
+   // hardware counters is given, the counters are read for every timed repetition as well.
+   class Runner
+   {
+    public:
+      Runner( size_t warmup, size_t repetitions, PerfCounters* counters = nullptr )
+         : warmup_{ warmup }
+         , repetitions_{ std::max( repetitions, size_t{1UL} ) }
+         , counters_{ counters != nullptr && counters->available() ? counters : nullptr }
+      {}
+
+      template< typename Kernel >
+      Result run( std::string name, Kernel&& kernel ) const
+      {
+         using Clock = std::chrono::steady_clock;
+
+         for( size_t i=0UL; i<warmup_; ++i ) {
+            kernel();
+         }
+
+         Result result{ std::move(name), {}, {}, {}, {} };
+         result.samples.reserve( repetitions_ );
+
+         if( counters_ != nullptr ) {
+            for( const PerfCounters::Counter& counter : counters_->counters() ) {
+               result.counters.push_back( CounterSamples{ counter.name, {} } );
+            }
+         }
+
+         for( size_t i=0UL; i<repetitions_; ++i )
+         {
+            if( counters_ != nullptr )
+               counters_->start();
+
+            const Clock::time_point start( Clock::now() );
+            kernel();
+            const Clock::time_point end( Clock::now() );
+
+            if( counters_ != nullptr )
+            {
+               counters_->stop();
+
+               const std::vector< std::optional<double> > values( counters_->read() );
+               for( size_t c=0UL; c<values.size(); ++c ) {
+                  result.counters[c].values.push_back( values[c] );
+               }
+            }
+
+            const std::chrono::duration<double> elapsedTime( end - start );
+            result.samples.push_back( elapsedTime.count() );
+         }
+
+         result.stats = compute_statistics( result.samples );
+
+         return result;
+      }
+
+      size_t warmup() const { return warmup_; }
+      size_t repetitions() const { return repetitions_; }
+
+    private:
+      size_t warmup_;
+      size_t repetitions_;
+      PerfCounters* counters_;
+   };
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // The translation vectors applied in every step. In buffered mode all vectors are generated up
+   // front into one contiguous buffer that is streamed through during the timed loop, such that
+   // the measurement only contains the dispatch and update cost. In in_loop mode the vectors are
+   // drawn from the random number generator inside the timed loop, as in the original benchmarks.
+   enum class TranslationMode
+   {
+      buffered,
+      in_loop
+   };
+
+   inline const char* to_string( TranslationMode mode )
+   {
+      switch( mode ) {
+         case TranslationMode::buffered: return "buffered";
+         case TranslationMode::in_loop:  return "rng-in-loop";
+      }
+      return "";
+   }
+
+   //**********************************************************************************************
+   // The order of circles and squares in the shape sequence. random draws every kind with equal
+   // probability, sorted puts all circles in front of all squares, alternating switches the kind
+   // with every shape and runs:L switches the kind after every L shapes.
+   struct ShapeOrder
+   {
+      enum Kind
+      {
+         random,
+         sorted,
+         alternating,
+         runs
+      };
+
+      Kind kind{ random };
+      size_t run_length{ 1UL };
+   };
+
+   inline std::string to_string( const ShapeOrder& order )
+   {
+      switch( order.kind ) {
+         case ShapeOrder::random:      return "random";
+         case ShapeOrder::sorted:      return "sorted";
+         case ShapeOrder::alternating: return "alternating";
+         case ShapeOrder::runs:        return "runs:" + std::to_string( order.run_length );
+      }
+      return "";
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // The heap layout of pointer-based Shapes containers (std::vector<std::unique_ptr<Shape>>).
+   // fresh allocates all shapes back-to-back in container order on a fresh heap. fragmented
+   // allocates the shapes in random order, interleaved with decoy allocations of random size of
+   // which a random half is freed again. churn:S additionally frees and reallocates a tenth of the
+   // shapes after every S steps, each together with one to three decoys, such that the number of
+   // live allocations stays the same (the reallocation is part of the timed loop). Containers of
+   // values, e.g. std::vector<std::variant<Circle,Square>>, are not affected.
+   struct AllocationMode
+   {
+      enum Kind
+      {
+         fresh,
+         fragmented,
+         churn
+      };
+
+      Kind kind{ fresh };
+      size_t interval{ 1000UL };
+   };
+
+   inline std::string to_string( const AllocationMode& alloc )
+   {
+      switch( alloc.kind ) {
+         case AllocationMode::fresh:      return "fresh";
+         case AllocationMode::fragmented: return "fragmented";
+         case AllocationMode::churn:      return "churn:" + std::to_string( alloc.interval );
+      }
+      return "";
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // for_each() and generate() may be called concurrently from several threads; in in_loop mode
+   // every call draws the same sequence of vectors from its own random number generator.
+   template< typename Vector >
+   class Translations
+   {
+    public:
+      Translations( TranslationMode mode, size_t steps, unsigned int seed )
+         : mode_{ mode }
+         , steps_{ steps }
+         , seed_{ seed }
+      {
+         if( mode_ == TranslationMode::buffered )
+         {
+            std::mt19937 rng{ seed_ };
+            buffer_.reserve( steps_ );
+            for( size_t s=0UL; s<steps_; ++s ) {
+               buffer_.push_back( make_vector( rng ) );
+            }
+         }
+      }
+
+      template< typename Fn >
+      void for_each( Fn&& fn ) const
+      {
+         if( mode_ == TranslationMode::buffered )
+         {
+            for( const Vector& v : buffer_ ) {
+               fn( v );
+            }
+         }
+         else
+         {
+            std::mt19937 rng{ seed_ };
+            for( size_t s=0UL; s<steps_; ++s ) {
+               fn( make_vector( rng ) );
+            }
+         }
+      }
+
+      // Calls between() after every interval steps.
+      template< typename Fn, typename Between >
+      void for_each( Fn&& fn, size_t interval, Between&& between ) const
+      {
+         size_t step( 0UL );
+
+         for_each( [&]( const Vector& v )
+         {
+            fn( v );
+
+            if( ++step == interval ) {
+               between();
+               step = 0UL;
+            }
+         } );
+      }
+
+      // The producer of the batched pipeline: yields the same vectors as for_each().
+      pipeline::Generator<Vector> generate() const
+      {
+         if( mode_ == TranslationMode::buffered )
+         {
+            for( const Vector& v : buffer_ ) {
+               co_yield v;
+            }
+         }
+         else
+         {
+            std::mt19937 rng{ seed_ };
+            for( size_t s=0UL; s<steps_; ++s ) {
+               co_yield make_vector( rng );
+            }
+         }
+      }
+
+      TranslationMode mode() const { return mode_; }
+      size_t steps() const { return steps_; }
+
+    private:
+      // The element type of Vector may be narrower than double (e.g. float).
+      static Vector make_vector( std::mt19937& rng )
+      {
+         std::uniform_real_distribution<double> dist( 0.0, 1.0 );
+
+         using Element = decltype( Vector{}.x );
+         const Element x( static_cast<Element>( dist( rng ) ) );
+         const Element y( static_cast<Element>( dist( rng ) ) );
+         return Vector{ x, y };
+      }
+
+      TranslationMode mode_;
+      size_t steps_;
+      unsigned int seed_;
+      std::vector<Vector> buffer_;
+   };
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   inline void print( std::ostream& os, const Result& result, size_t width = 32UL )
+   {
+      const Statistics& s( result.stats );
+
+      const auto flags( os.flags() );
+      const auto precision( os.precision() );
+
+      const std::string& label( result.label.empty() ? result.name : result.label );
+
+      os << " " << std::left << std::setw( static_cast<int>( width ) ) << label << std::right
+         << ": median " << std::fixed << std::setprecision( 4 ) << s.median << "s"
+         << "  MAD " << s.mad << "s"
+         << "  min " << s.min << "s"
+         << "  p90 " << s.p90 << "s"
+         << "  95% CI [" << s.ci_lower << "s, " << s.ci_upper << "s]"
+         << "  (n=" << s.samples << ")";
+
+      if( result.heap_bytes > 0UL && result.shapes > 0UL )
+         os << "  heap " << std::setprecision( 1 )
+            << static_cast<double>( result.heap_bytes ) / static_cast<double>( result.shapes ) << " B/shape";
+
+      if( result.code_bytes > 0UL )
+         os << "  code " << result.code_bytes << " B";
+
+      os << "\n";
+
+      if( !result.counters.empty() && result.updates() > 0.0 )
+      {
+         os << " " << std::setw( static_cast<int>( width ) ) << "" << "  per shape:" << std::setprecision( 3 );
+
+         for( const CounterSamples& counter : result.counters )
+         {
+            const double value( result.counter_per_shape( counter.name ) );
+
+            os << "  " << counter.name << " ";
+            if( value >= 0.0 )
+               os << value;
+            else
+               os << "n/a";
+         }
+
+         const double cycles( result.counter_per_shape( "cycles" ) );
+         const double instructions( result.counter_per_shape( "instructions" ) );
+         if( cycles > 0.0 && instructions >= 0.0 )
+            os << "  IPC " << instructions / cycles;
+
+         os << "\n";
+      }
+
+      os.flags( flags );
+      os.precision( precision );
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Command line configuration. Every option has the form --name=value, see print_usage().
+   struct Config
+   {
+      size_t shapes{ 100UL };
+      size_t steps{ 2500000UL };
+      bool random_seed{ true };
+      unsigned int seed{};
+      size_t warmup{ 1UL };
+      size_t repetitions{ 10UL };
+      TranslationMode translations{ TranslationMode::buffered };
+      ShapeOrder order{};
+      AllocationMode alloc{};
+      std::vector<size_t> types;
+      std::vector<std::string> filter;
+      bool counters{ false };
+      std::string csv;
+      std::string json;
+      std::string baseline;
+      double threshold{ 0.05 };
+      double alpha{ 0.01 };
+      bool sweep{ false };
+      size_t sweep_min{ 16UL };
+      size_t sweep_max{ 16777216UL };
+      size_t sweep_factor{ 4UL };
+      std::vector<size_t> threads;
+      size_t imbalance{};
+      bool aligned_chunks{ false };
+      bool false_sharing{ false };
+      std::vector<size_t> batch;
+      std::vector<pipeline::Combine> combines{ pipeline::Combine::summed, pipeline::Combine::sequenced };
+      std::vector<size_t> lazy;
+      std::vector<parallel::Schedule> schedules{ parallel::default_schedules() };
+      bool help{ false };
+
+      // Returns whether the solution with the given name is selected. An opt-in solution is only
+      // selected if it is named by --filter.
+      bool selected( const std::string& name, bool opt_in = false ) const
+      {
+         if( filter.empty() )
+            return !opt_in;
+
+         return std::any_of( filter.begin(), filter.end(), [&]( const std::string& f ){
+            return name.find( f ) != std::string::npos;
+         } );
+      }
+   };
+
+   inline size_t parse_size( const std::string& option, const std::string& value )
+   {
+      size_t pos{};
+      unsigned long long result{};
+
+      try {
+         result = std::stoull( value, &pos );
+      }
+      catch( const std::exception& ) {
+         pos = 0UL;
+      }
+
+      if( value.empty() || pos != value.size() || value.front() == '-' )
+         throw std::invalid_argument( "Invalid value '" + value + "' for option " + option );
+
+      return static_cast<size_t>( result );
+   }
+
+   inline double parse_percentage( const std::string& option, const std::string& value )
+   {
+      size_t pos{};
+      double result{};
+
+      try {
+         result = std::stod( value, &pos );
+      }
+      catch( const std::exception& ) {
+         pos = 0UL;
+      }
+
+      if( value.empty() || pos != value.size() || !( result >= 0.0 ) )
+         throw std::invalid_argument( "Invalid value '" + value + "' for option " + option );
+
+      return result;
+   }
+
+   inline double parse_probability( const std::string& option, const std::string& value )
+   {
+      size_t pos{};
+      double result{};
+
+      try {
+         result = std::stod( value, &pos );
+      }
+      catch( const std::exception& ) {
+         pos = 0UL;
+      }
+
+      if( value.empty() || pos != value.size() || !( result > 0.0 && result < 1.0 ) )
+         throw std::invalid_argument( "Invalid value '" + value + "' for option " + option );
+
+      return result;
+   }
+
+   inline ShapeOrder parse_shape_order( const std::string& option, const std::string& value )
+   {
+      if( value == "random" )      return ShapeOrder{ ShapeOrder::random, 1UL };
+      if( value == "sorted" )      return ShapeOrder{ ShapeOrder::sorted, 1UL };
+      if( value == "alternating" ) return ShapeOrder{ ShapeOrder::alternating, 1UL };
+
+      if( value.compare( 0UL, 5UL, "runs:" ) == 0 ) {
+         const size_t length( parse_size( option, value.substr( 5UL ) ) );
+         if( length > 0UL )
+            return ShapeOrder{ ShapeOrder::runs, length };
+      }
+
+      throw std::invalid_argument( "Invalid value '" + value + "' for option " + option );
+   }
+
+   inline AllocationMode parse_allocation_mode( const std::string& option, const std::string& value )
+   {
+      if( value == "fresh" )      return AllocationMode{ AllocationMode::fresh, 1000UL };
+      if( value == "fragmented" ) return AllocationMode{ AllocationMode::fragmented, 1000UL };
+      if( value == "churn" )      return AllocationMode{ AllocationMode::churn, 1000UL };
+
+      if( value.compare( 0UL, 6UL, "churn:" ) == 0 ) {
+         const size_t interval( parse_size( option, value.substr( 6UL ) ) );
+         if( interval > 0UL )
+            return AllocationMode{ AllocationMode::churn, interval };
+      }
+
+      throw std::invalid_argument( "Invalid value '" + value + "' for option " + option );
+   }
+
+   inline size_t parse_shape_type_count( const std::string& option, const std::string& value )
+   {
+      const size_t K( parse_size( option, value ) );
+
+      if( !shape_types::contains( K, shape_types::Counts{} ) )
+         throw std::invalid_argument( "Unsupported number of shape types '" + value + "' for option " + option );
+
+      return K;
+   }
+
+   inline parallel::Schedule parse_schedule( const std::string& option, const std::string& value )
+   {
+      for( parallel::Schedule schedule : { parallel::Schedule::static_chunks
+                                         , parallel::Schedule::stealing
+                                         , parallel::Schedule::par_unseq } ) {
+         if( value == parallel::to_string( schedule ) )
+            return schedule;
+      }
+
+      throw std::invalid_argument( "Invalid value '" + value + "' for option " + option );
+   }
+
+   inline pipeline::Combine parse_combine( const std::string& option, const std::string& value )
+   {
+      if( value == "summed" )    return pipeline::Combine::summed;
+      if( value == "sequenced" ) return pipeline::Combine::sequenced;
+
+      throw std::invalid_argument( "Invalid value '" + value + "' for option " + option );
+   }
+
+   // Returns the thread counts of the --scaling mode: 1, 2, 4, ... up to the number of hardware
+   // threads, which is always included.
+   inline std::vector<size_t> scaling_threads()
+   {
+      const size_t hardware( std::max( static_cast<size_t>( std::thread::hardware_concurrency() ), size_t{1UL} ) );
+
+      std::vector<size_t> threads;
+      for( size_t T=1UL; T<hardware; T*=2UL ) {
+         threads.push_back( T );
+      }
+      threads.push_back( hardware );
+
+      return threads;
+   }
+
+   // Prints a warning if more threads are requested than the hardware provides, in which case the
+   // threads time-share the cores and the results say nothing about the saturation of the memory
+   // bandwidth. Returns whether this is the case, or false if the number of hardware threads is
+   // unknown.
+   inline bool warn_oversubscription( std::ostream& os, const std::vector<size_t>& threads )
+   {
+      const size_t hardware( std::thread::hardware_concurrency() );
+      const size_t requested( threads.empty() ? 0UL : *std::max_element( threads.begin(), threads.end() ) );
+
+      if( hardware == 0UL || requested <= hardware )
+         return false;
+
+      os << " Warning: " << requested << " threads requested, but only " << hardware
+         << " hardware thread(s) available; the rows above " << hardware
+         << " thread(s) are oversubscribed and no crossover is reported\n";
+      return true;
+   }
+
+   inline std::vector<std::string> split( const std::string& list, char delimiter = ',' )
+   {
+      std::vector<std::string> result;
+      std::string::size_type begin{};
+
+      while( begin <= list.size() )
+      {
+         const std::string::size_type end( std::min( list.find( delimiter, begin ), list.size() ) );
+         if( end > begin )
+            result.push_back( list.substr( begin, end-begin ) );
+         begin = end + 1UL;
+      }
+
+      return result;
+   }
+
+   inline Config parse_command_line( int argc, char** argv )
+   {
+      Config config{};
+      bool order( false );  // --order given explicitly
+
+      for( int i=1; i<argc; ++i )
+      {
+         const std::string arg( argv[i] );
+         const std::string::size_type eq( arg.find( '=' ) );
+         const std::string option( arg.substr( 0UL, eq ) );
+         const std::string value( eq == std::string::npos ? std::string{} : arg.substr( eq+1UL ) );
+
+         if( option == "--help" || option == "-h" ) {
+            config.help = true;
+         }
+         else if( option == "--shapes" ) {
+            config.shapes = parse_size( option, value );
+         }
+         else if( option == "--steps" ) {
+            config.steps = parse_size( option, value );
+         }
+         else if( option == "--seed" ) {
+            config.random_seed = ( value == "random" );
+            if( !config.random_seed )
+               config.seed = static_cast<unsigned int>( parse_size( option, value ) );
+         }
+         else if( option == "--warmup" ) {
+            config.warmup = parse_size( option, value );
+         }
+         else if( option == "--repetitions" ) {
+            config.repetitions = parse_size( option, value );
+         }
+         else if( option == "--filter" ) {
+            config.filter = split( value );
+         }
+         else if( option == "--counters" ) {
+            config.counters = true;
+         }
+         else if( option == "--csv" || option == "--json" ) {
+            if( value.empty() )
+               throw std::invalid_argument( "Missing file name for option " + option );
+            ( option == "--csv" ? config.csv : config.json ) = value;
+         }
+         else if( option == "--baseline" ) {
+            if( value.empty() )
+               throw std::invalid_argument( "Missing file name for option " + option );
+            config.baseline = value;
+         }
+         else if( option == "--threshold" ) {
+            config.threshold = parse_percentage( option, value ) / 100.0;
+         }
+         else if( option == "--alpha" ) {
+            config.alpha = parse_probability( option, value );
+         }
+         else if( option == "--sweep" ) {
+            config.sweep = true;
+         }
+         else if( option == "--sweep-min" ) {
+            config.sweep_min = parse_size( option, value );
+         }
+         else if( option == "--sweep-max" ) {
+            config.sweep_max = parse_size( option, value );
+         }
+         else if( option == "--sweep-factor" ) {
+            config.sweep_factor = parse_size( option, value );
+         }
+         else if( option == "--types" ) {
+            config.types.clear();
+            for( const std::string& type : split( value ) ) {
+               config.types.push_back( parse_shape_type_count( option, type ) );
+            }
+            if( config.types.empty() )
+               throw std::invalid_argument( "Missing value for option " + option );
+         }
+         else if( option == "--threads" ) {
+            config.threads.clear();
+            for( const std::string& count : split( value ) ) {
+               config.threads.push_back( parse_size( option, count ) );
+               if( config.threads.back() == 0UL )
+                  throw std::invalid_argument( "Invalid value '" + count + "' for option " + option );
+            }
+            if( config.threads.empty() )
+               throw std::invalid_argument( "Missing value for option " + option );
+         }
+         else if( option == "--scaling" ) {
+            config.threads = scaling_threads();
+         }
+         else if( option == "--aligned-chunks" ) {
+            config.aligned_chunks = true;
+         }
+         else if( option == "--false-sharing" ) {
+            config.false_sharing = true;
+         }
+         else if( option == "--imbalance" ) {
+            config.imbalance = parse_size( option, value );
+            if( config.imbalance == 0UL )
+               throw std::invalid_argument( "Invalid value '" + value + "' for option " + option );
+         }
+         else if( option == "--schedule" ) {
+            config.schedules.clear();
+            for( const std::string& schedule : split( value ) ) {
+               config.schedules.push_back( parse_schedule( option, schedule ) );
+            }
+            if( config.schedules.empty() )
+               throw std::invalid_argument( "Missing value for option " + option );
+         }
+         else if( option == "--batch" ) {
+            config.batch.clear();
+            for( const std::string& steps : split( value ) ) {
+               config.batch.push_back( parse_size( option, steps ) );
+               if( config.batch.back() == 0UL )
+                  throw std::invalid_argument( "Invalid value '" + steps + "' for option " + option );
+            }
+            if( config.batch.empty() )
+               throw std::invalid_argument( "Missing value for option " + option );
+         }
+         else if( option == "--combine" ) {
+            config.combines.clear();
+            for( const std::string& combine : split( value ) ) {
+               config.combines.push_back( parse_combine( option, combine ) );
+            }
+            if( config.combines.empty() )
+               throw std::invalid_argument( "Missing value for option " + option );
+         }
+         else if( option == "--lazy" ) {
+            config.lazy.clear();
+            for( const std::string& interval : split( value ) ) {
+               config.lazy.push_back( parse_size( option, interval ) );
+               if( config.lazy.back() == 0UL )
+                  throw std::invalid_argument( "Invalid value '" + interval + "' for option " + option );
+            }
+            if( config.lazy.empty() )
+               throw std::invalid_argument( "Missing value for option " + option );
+         }
+         else if( option == "--alloc" ) {
+            config.alloc = parse_allocation_mode( option, value );
+         }
+         else if( option == "--order" ) {
+            config.order = parse_shape_order( option, value );
+            order = true;
+         }
+         else if( option == "--rng-in-loop" ) {
+            config.translations = TranslationMode::in_loop;
+         }
+         else {
+            throw std::invalid_argument( "Unknown option " + arg );
+         }
+      }
+
+      if( config.sweep && !config.types.empty() )
+         throw std::invalid_argument( "--sweep and --types cannot be combined" );
+
+      if( !config.threads.empty() && ( config.sweep || !config.types.empty() ) )
+         throw std::invalid_argument( "--threads and --scaling cannot be combined with --sweep or --types" );
+
+      if( !config.batch.empty() && ( config.sweep || !config.types.empty() || !config.threads.empty() ) )
+         throw std::invalid_argument( "--batch cannot be combined with --sweep, --types, --threads or --scaling" );
+
+      if( !config.batch.empty() && config.alloc.kind == AllocationMode::churn )
+         throw std::invalid_argument( "--batch cannot be combined with --alloc=churn" );
+
+      if( !config.batch.empty() && !config.baseline.empty() )
+         throw std::invalid_argument( "--batch cannot be combined with --baseline" );
+
+      if( !config.lazy.empty() && ( config.sweep || !config.types.empty() || !config.threads.empty() || !config.batch.empty() ) )
+         throw std::invalid_argument( "--lazy cannot be combined with --sweep, --types, --threads, --scaling or --batch" );
+
+      if( !config.lazy.empty() && config.alloc.kind == AllocationMode::churn )
+         throw std::invalid_argument( "--lazy cannot be combined with --alloc=churn" );
+
+      if( !config.lazy.empty() && !config.baseline.empty() )
+         throw std::invalid_argument( "--lazy cannot be combined with --baseline" );
+
+      if( config.false_sharing && config.threads.empty() )
+         throw std::invalid_argument( "--false-sharing requires --threads or --scaling" );
+
+      if( config.false_sharing && ( config.imbalance > 0UL || config.aligned_chunks ) )
+         throw std::invalid_argument( "--false-sharing cannot be combined with --imbalance or --aligned-chunks" );
+
+      // The false sharing penalty is normalized by the result of one thread.
+      if( config.false_sharing && std::find( config.threads.begin(), config.threads.end(), 1UL ) == config.threads.end() )
+         config.threads.insert( config.threads.begin(), 1UL );
+
+      if( config.imbalance > 0UL && config.threads.empty() )
+         throw std::invalid_argument( "--imbalance requires --threads or --scaling" );
+
+      if( config.imbalance > 0UL && order && config.order.kind != ShapeOrder::sorted )
+         throw std::invalid_argument( "--imbalance requires --order=sorted" );
+
+      // The imbalance benchmark implies the sorted order.
+      if( config.imbalance > 0UL )
+         config.order = ShapeOrder{ ShapeOrder::sorted, 1UL };
+
+      if( !config.threads.empty() && config.alloc.kind == AllocationMode::churn )
+         throw std::invalid_argument( "--threads and --scaling cannot be combined with --alloc=churn" );
+
+      if( !config.threads.empty() && !config.baseline.empty() )
+         throw std::invalid_argument( "--threads and --scaling cannot be combined with --baseline" );
+
+      if( config.sweep && ( config.sweep_min == 0UL || config.sweep_min > config.sweep_max || config.sweep_factor < 2UL ) )
+         throw std::invalid_argument( "Invalid sweep range" );
+
+      return config;
+   }
+
+   inline void print_usage( std::ostream& os, const std::string& binary
+                          , const std::vector<std::string>& solutions )
+   {
+      os << "Usage: " << binary << " [options]\n"
+         << "\n"
+         << "  --shapes=N          number of shapes (default 100)\n"
+         << "  --steps=N           number of translation steps (default 2500000)\n"
+         << "  --seed=N|random     seed of the random number generator (default random)\n"
+         << "  --warmup=N          untimed warm-up runs per solution (default 1)\n"
+         << "  --repetitions=N     timed repetitions per solution (default 10)\n"
+         << "  --filter=A,B,...    only run solutions whose name contains one of the given strings\n"
+         << "  --order=ORDER       order of circles and squares: random (default), sorted, alternating\n"
+         << "                      or runs:L for alternating runs of L shapes of the same kind\n"
+         << "  --types=K,K,...     benchmark the generated solutions with K shape types each\n"
+         << "                      (K in 2,4,8,16,32,64) instead of circles and squares\n"
+         << "  --alloc=MODE        heap layout of pointer-based shapes: fresh (default), fragmented\n"
+         << "                      or churn:S to also reallocate 10% of the shapes every S steps\n"
+         << "  --rng-in-loop       draw the translation vectors inside the timed loop\n"
+         << "  --counters          measure hardware performance counters (Linux perf_event_open)\n"
+         << "  --csv=FILE          write one CSV record per solution, size and repetition to FILE\n"
+         << "  --json=FILE         write the same records as a JSON array to FILE\n"
+         << "  --baseline=FILE     compare with a CSV file written by --csv, fail on regressions\n"
+         << "  --threshold=PCT     slowdown of the median that counts as regression (default 5)\n"
+         << "  --alpha=P           significance level of the Mann-Whitney U test (default 0.01)\n"
+         << "                      (needs at least 6 repetitions in baseline and run, 4 for 0.05)\n"
+         << "  --sweep             sweep the number of shapes from L1 to DRAM sized working sets\n"
+         << "  --sweep-min=N       smallest number of shapes in the sweep (default 16)\n"
+         << "  --sweep-max=N       largest number of shapes in the sweep (default 16777216)\n"
+         << "  --sweep-factor=N    growth factor between sweep points (default 4)\n"
+         << "  --threads=T,T,...   translate the shapes in parallel with each number of threads\n"
+         << "  --scaling           same as --threads=1,2,4,... up to the number of hardware threads\n"
+         << "  --schedule=S,S,...  parallel schedules: static, stealing, par_unseq (default all; without\n"
+         << "                      -DBENCHMARK_PARALLEL_STL par_unseq runs serially and is left out)\n"
+         << "  --imbalance=F       with --threads: squares cost F times more than circles (implies\n"
+         << "                      --order=sorted)\n"
+         << "  --aligned-chunks    with --threads: move the chunk boundaries to cache line boundaries\n"
+         << "  --false-sharing     with --threads: measure the false sharing of one-shape chunks dealt\n"
+         << "                      out round-robin, with and without cache line aligned boundaries\n"
+         << "  --batch=K,K,...     compare the per-step loop with a coroutine pipeline that applies K\n"
+         << "                      steps per pass over the shapes\n"
+         << "  --combine=C,C,...   how a batch is applied: summed, sequenced (default both)\n"
+         << "  --lazy=R,R,...      compare the per-step loop with deferred translations that are applied\n"
+         << "                      when the positions are read, every R steps\n"
+         << "  --help              print this message\n"
+         << "\n"
+         << "Solutions:\n";
+
+      for( const std::string& name : solutions ) {
+         os << "  " << name << "\n";
+      }
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   inline std::vector<size_t> sweep_sizes( size_t min, size_t max, size_t factor )
+   {
+      std::vector<size_t> sizes;
+
+      for( size_t N=min; N<=max; N*=factor ) {
+         sizes.push_back( N );
+         if( N > max / factor )
+            break;
+      }
+
+      return sizes;
+   }
+
+   inline std::vector< std::pair<std::string,long> > cache_sizes()
+   {
+      std::vector< std::pair<std::string,long> > sizes;
+
+#if defined(_SC_LEVEL1_DCACHE_SIZE) && defined(_SC_LEVEL2_CACHE_SIZE) && defined(_SC_LEVEL3_CACHE_SIZE)
+      const std::pair<std::string,long> levels[] = {
+         { "L1d", sysconf( _SC_LEVEL1_DCACHE_SIZE ) },
+         { "L2",  sysconf( _SC_LEVEL2_CACHE_SIZE ) },
+         { "L3",  sysconf( _SC_LEVEL3_CACHE_SIZE ) }
+      };
+
+      for( const auto& level : levels ) {
+         if( level.second > 0L )
+            sizes.push_back( level );
+      }
+#endif
+
+      return sizes;
+   }
+
+   inline std::string cache_summary()
+   {
+      std::string summary( "caches:" );
+
+      for( const auto& level : cache_sizes() ) {
+         summary += " " + level.first + " " + std::to_string( level.second / 1024L ) + " KiB";
+      }
+
+      return summary == "caches:" ? "caches: unknown" : summary;
+   }
+
+   inline std::string cache_level( size_t bytes )
+   {
+      const auto sizes( cache_sizes() );
+
+      if( sizes.empty() )
+         return "?";
+
+      for( const auto& level : sizes ) {
+         if( bytes <= static_cast<size_t>( level.second ) )
+            return level.first;
+      }
+
+      return "DRAM";
+   }
+
+   // The size of one shape of the value-based solutions for the given vector type, i.e. of a variant
+   // of a circle and a square that store a double (radius or side) and a center each. The working
+   // sets of the pointer-based solutions (a pointer per shape plus a separately allocated object)
+   // and of the SoA store differ from it.
+   template< typename Vector >
+   inline constexpr size_t value_shape_bytes = []{
+      struct Shape { double size; Vector center; };
+      return sizeof( std::variant<Shape,Shape> );
+   }();
+
+   // Returns the number of bytes currently allocated from the heap, including the allocator's
+   // per-chunk overhead, or 0 if this cannot be queried (requires glibc 2.33 or later). Chunks
+   // in glibc's per-thread cache count as allocated, which hides up to a few KiB of reused
+   // memory, i.e. the value is only meaningful for large differences.
+   inline size_t heap_in_use()
+   {
+#if defined(__GLIBC__) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 33 ) )
+      const struct mallinfo2 info( mallinfo2() );
+      return info.uordblks + info.hblkhd;
+#else
+      return 0UL;
+#endif
+   }
+
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // The shapes of a benchmark run are described independently of any solution, such that every
+   // solution works on exactly the same sequence of circles and squares. The sizes are always
+   // random, the kinds follow the requested ShapeOrder. The sorted order contains the same shapes
+   // as the random order. For the generated solutions with K shape types, type is the index of
+   // the shape type in [0,K); with the default of two types it is 0 for circles and 1 for squares.
+   enum class ShapeKind
+   {
+      circle,
+      square
+   };
+
+   struct ShapeSpec
+   {
+      ShapeKind kind;
+      double size;
+      size_t type;
+   };
+
+   using ShapeSpecs = std::vector<ShapeSpec>;
+
+   inline ShapeSpecs make_shape_specs( size_t N, unsigned int seed, const ShapeOrder& order = ShapeOrder{}
+                                     , size_t types = 2UL )
+   {
+      std::mt19937 rng{ seed };
+      std::uniform_real_distribution<double> dist( 0.0, 1.0 );
+
+      ShapeSpecs specs;
+      specs.reserve( N );
+
+      const auto kindOf = []( size_t type ) {
+         return type == 0UL ? ShapeKind::circle : ShapeKind::square;
+      };
+
+      for( size_t i=0UL; i<N; ++i ) {
+         const size_t type( std::min( static_cast<size_t>( dist( rng ) * static_cast<double>( types ) ), types-1UL ) );
+         specs.push_back( ShapeSpec{ kindOf( type ), dist( rng ), type } );
+      }
+
+      switch( order.kind )
+      {
+         case ShapeOrder::random:
+            break;
+
+         case ShapeOrder::sorted:
+            std::stable_sort( specs.begin(), specs.end(), []( const ShapeSpec& a, const ShapeSpec& b ){
+               return a.type < b.type;
+            } );
+            break;
+
+         case ShapeOrder::alternating:
+         case ShapeOrder::runs:
+            for( size_t i=0UL; i<N; ++i ) {
+               specs[i].type = ( i / order.run_length ) % types;
+               specs[i].kind = kindOf( specs[i].type );
+            }
+            break;
+      }
+
+      return specs;
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // The cost model of the imbalance benchmark (--imbalance=F), i.e. of shape types with more
+   // operations than the translation. After the translation of a range of shapes, the harness
+   // performs one unit of work for every circle and F units for every square of the range. A unit
+   // is a short dependent chain of multiply-adds, which costs about as much as the translation of
+   // one shape. The work is assigned in container order, which is the order of the specs in every
+   // container for the sorted order (all circles in front of all squares).
+   constexpr size_t work_unit_length = 4UL;
+
+   inline std::vector<size_t> make_costs( const ShapeSpecs& specs, size_t factor )
+   {
+      std::vector<size_t> costs;
+      costs.reserve( specs.size() );
+
+      for( const ShapeSpec& spec : specs ) {
+         costs.push_back( spec.kind == ShapeKind::circle ? 1UL : factor );
+      }
+
+      return costs;
+   }
+
+   inline double imbalance_work( double x, size_t units )
+   {
+      for( size_t i=0UL; i<units*work_unit_length; ++i ) {
+         x = x * 0.9999999 + 1E-7;
+      }
+      return x;
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // A set of solutions that are benchmarked on the same shapes and translations. Every solution
+   // is registered with a factory that turns a ShapeSpecs sequence into its own Shapes container.
+   // The container is translated by translate_shapes( shapes, v ), whose unqualified call finds
+   // the translate() function of the solution's namespace. A solution can additionally register a
+   // generated variant for K shape types, whose factory receives K as std::integral_constant.
+   // Solutions that store pointers to shapes are instead registered with a factory for a single
+   // ShapeSpec, from which the suite assembles the container; the fragmented and churning heap
+   // modes allocate the shapes one by one through this factory.
+   // For the parallel runs, the sequenced pipeline and the deferred translations, a part [begin,end) of the container is
+   // translated either via translate( shapes, v, begin, end ) or, for contiguous containers, via
+   // translate( span, v ).
+   template< typename Vector >
+   class Suite
+   {
+    public:
+      explicit Suite( std::string binary )
+         : binary_{ std::move(binary) }
+      {}
+
+      // The thread pool and schedule of a parallel run, the costs of the imbalance benchmark and
+      // the chunking of the shapes.
+      struct Parallel
+      {
+         parallel::ThreadPool& pool;
+         parallel::Schedule schedule;
+         const std::vector<size_t>* costs{};  // nullptr unless --imbalance
+         size_t chunks{};                     // number of chunks, 0 for the default of the schedule
+         bool aligned{ false };               // chunk boundaries moved to cache line boundaries
+
+         std::string label() const
+         {
+            return parallel::to_string( schedule ) + ( serial() ? "/serial" : "" )
+                                                   + ( chunks > 0UL ? "/interleaved" : "" )
+                                                   + ( aligned ? "/aligned" : "" );
+         }
+
+         // Whether the schedule falls back to running all chunks on the calling thread.
+         bool serial() const
+         {
+            return schedule == parallel::Schedule::par_unseq && !parallel::parallel_algorithms;
+         }
+      };
+
+      // The number of steps per batch and the consumer of the batched pipeline.
+      struct Batching
+      {
+         size_t steps;
+         pipeline::Combine combine;
+      };
+
+      // The number of steps between two reads of the positions and the recording of the deferred
+      // translations. An interval of 0 translates the subsets of the per_shape deferral immediately,
+      // i.e. it is the per-step loop the per_shape deferral is compared with.
+      struct Lazy
+      {
+         size_t interval;
+         lazy::Deferral deferral;
+      };
+
+      struct Context
+      {
+         const Config& config;
+         const Runner& runner;
+         const ShapeSpecs& specs;
+         const Translations<Vector>& translations;
+         const Parallel* parallel{};  // nullptr for the sequential loop
+         const Batching* batching{};  // nullptr for the per-step loop
+         const Lazy* lazy{};          // nullptr for the immediate translation
+      };
+
+      using RunFunction = std::function<Result( const std::string&, const Context& )>;
+
+      // The code size of a solution is measured for the functions of the namespace scope, which
+      // defaults to the name of the solution.
+      template< typename Factory >
+      void add( std::string name, std::string label, Factory factory, std::string scope = {} )
+      {
+         if( scope.empty() )
+            scope = name;
+
+         solutions_.push_back( Solution{ std::move(name), std::move(label), std::move(scope), make_run( factory ), {} } );
+      }
+
+      // Registers a solution that only runs if it is named by --filter, e.g. a solution that relies
+      // on undefined behavior tolerated by the platform.
+      template< typename Factory >
+      void add_opt_in( std::string name, std::string label, Factory factory, std::string scope = {} )
+      {
+         add( std::move(name), std::move(label), factory, std::move(scope) );
+         solutions_.back().opt_in = true;
+      }
+
+      template< typename Factory >
+      void add_generated( const std::string& name, Factory factory )
+      {
+         add_generated<VectorOfShapes>( name, factory );
+      }
+
+      // Registers the generated variant of a pointer-based solution whose container for K shape
+      // types is Shapes<K> instead of a std::vector of the shape pointers.
+      template< template<size_t> class Shapes, typename Factory >
+      void add_generated( const std::string& name, Factory factory )
+      {
+         for( Solution& solution : solutions_ ) {
+            if( solution.name == name )
+               add_generated<Shapes>( solution.generated, factory, shape_types::Counts{} );
+         }
+      }
+
+      int run( int argc, char** argv )
+      {
+         std::vector<std::string> names;
+         for( const Solution& solution : solutions_ ) {
+            names.push_back( solution.opt_in ? solution.name + " (only with --filter)" : solution.name );
+         }
+
+         Config config{};
+
+         try {
+            config = parse_command_line( argc, argv );
+         }
+         catch( const std::invalid_argument& ex ) {
+            std::cerr << ex.what() << "\n\n";
+            print_usage( std::cerr, argv[0], names );
+            return EXIT_FAILURE;
+         }
+
+         if( config.help ) {
+            print_usage( std::cout, argv[0], names );
+            return EXIT_SUCCESS;
+         }
+
+         if( config.random_seed ) {
+            std::random_device rd{};
+            config.seed = rd();
+         }
+
+         PerfCounters counters{};
+
+         if( config.counters && !counters.available() )
+            std::cerr << " Hardware counters unavailable (" << counters.error() << ")\n";
+
+         const Runner runner( config.warmup, config.repetitions, config.counters ? &counters : nullptr );
+
+         const std::vector<Result> results( config.sweep            ? run_sweep( config, runner )
+                                          : !config.types.empty()   ? run_types( config, runner )
+                                          : !config.batch.empty()   ? run_batching( config, runner )
+                                          : !config.lazy.empty()    ? run_lazy( config, runner )
+                                          : config.false_sharing    ? run_false_sharing( config, runner )
+                                          : !config.threads.empty() ? run_threads( config, runner )
+                                                                    : run_single( config, runner ) );
+
+         if( !write_results( config, results ) )
+            return EXIT_FAILURE;
+
+         return config.baseline.empty() || compare_baseline( config, results ) ? EXIT_SUCCESS : EXIT_FAILURE;
+      }
+
+    private:
+      struct Solution
+      {
+         std::string name;
+         std::string label;
+         std::string scope;
+         RunFunction run;
+         std::map<size_t,RunFunction> generated;
+         bool opt_in{ false };
+      };
+
+      // Stands for the default container of a factory for single shapes, i.e. a std::vector.
+      template< size_t K >
+      struct VectorOfShapes
+      {};
+
+      // Shapes is the container of a factory for single shapes, void for a std::vector.
+      template< typename Factory, typename Shapes = void >
+      static RunFunction make_run( Factory factory )
+      {
+         if constexpr( std::is_invocable_v<const Factory&, const ShapeSpec&> )
+            return make_run( make_container_factory<Shapes>( factory ), factory );
+         else
+            return make_run( factory, nullptr );
+      }
+
+      // Turns a factory for single shapes into a factory for the whole container.
+      template< typename Shapes, typename ShapeFactory >
+      static auto make_container_factory( ShapeFactory make_shape )
+      {
+         using Shape = std::invoke_result_t<const ShapeFactory&, const ShapeSpec&>;
+         using Container = std::conditional_t< std::is_void_v<Shapes>, std::vector<Shape>, Shapes >;
+
+         return [make_shape]( const ShapeSpecs& specs )
+         {
+            Container shapes;
+            shapes.reserve( specs.size() );
+
+            for( const ShapeSpec& spec : specs ) {
+               shapes.push_back( make_shape( spec ) );
+            }
+
+            return shapes;
+         };
+      }
+
+      // make_shape is the factory for single shapes, or nullptr for containers that are not
+      // assembled shape by shape.
+      template< typename Factory, typename ShapeFactory >
+      static RunFunction make_run( Factory factory, ShapeFactory make_shape )
+      {
+         return [factory,make_shape]( const std::string& n, const Context& context )
+         {
+            const AllocationMode& alloc( context.config.alloc );
+
+            Heap heap( context.config.seed + 2U );
+
+            warm_up( factory, context.specs );
+
+            const size_t before( heap_in_use() );
+            auto shapes( build( factory, make_shape, context.specs, alloc, heap ) );
+            const size_t after( heap_in_use() );
+
+            using Shapes = decltype( shapes );
+
+            // The decoys of the fragmented modes live on the same heap, hence the footprint of the
+            // shapes is only known for fresh allocations.
+            const auto footprint = [&]( Result result ){
+               if( alloc.kind == AllocationMode::fresh && after > before )
+                  result.heap_bytes = after - before;
+               return result;
+            };
+
+            if( context.parallel != nullptr )
+               return footprint( run_parallel( n, context, shapes ) );
+
+            if( context.batching != nullptr )
+               return footprint( run_batched( n, context, shapes ) );
+
+            if( context.lazy != nullptr )
+               return footprint( run_deferred( n, context, std::move(shapes) ) );
+
+            if constexpr( is_pointer_container<Shapes>::value )
+            {
+               if( alloc.kind == AllocationMode::churn )
+               {
+                  // All shapes are moved by the same translations, hence their common center is the
+                  // sum of all translations so far (over all repetitions), with the same rounding.
+                  Vector center{};
+
+                  return footprint( context.runner.run( n, [&]{
+                     context.translations.for_each( [&]( const Vector& v ){
+                        translate_shapes( shapes, v );
+                        center = center + v;
+                     }, alloc.interval, [&]{ heap.churn( make_shape, context.specs, shapes, center ); } );
+                  } ) );
+               }
+            }
+
+            return footprint( context.runner.run( n, [&]{
+               context.translations.for_each( [&]( const Vector& v ){ translate_shapes( shapes, v ); } );
+            } ) );
+         };
+      }
+
+      // Creates the lazily initialized statics of the harness (the symbol table of the code size)
+      // and of the solution (e.g. a registry of shared strategies) by building one shape of every
+      // type, such that they do not count towards the heap footprint of the first run.
+      template< typename Factory >
+      static void warm_up( const Factory& factory, const ShapeSpecs& specs )
+      {
+         function_symbols();
+
+         ShapeSpecs sample;
+         for( const ShapeSpec& spec : specs ) {
+            if( std::none_of( sample.begin(), sample.end(), [&]( const ShapeSpec& s ){ return s.type == spec.type; } ) )
+               sample.push_back( spec );
+         }
+
+         factory( sample );
+      }
+
+      // Splits the shapes into chunks according to the schedule and keeps the loop order of the
+      // sequential loop: every step is one parallel pass over all chunks, i.e. the threads
+      // synchronize once per step, and the results are comparable with the sequential loop and
+      // across schedules. For the imbalance benchmark every step is followed by the modeled work of
+      // the shapes of each chunk. The scheduler is set up outside of the timed region.
+      template< typename Shapes >
+      static Result run_parallel( const std::string& n, const Context& context, Shapes& shapes )
+      {
+         const Parallel& p( *context.parallel );
+         const size_t size( context.specs.size() );
+
+         std::vector<parallel::Chunk> chunks( p.chunks > 0UL ? parallel::make_chunks( size, p.chunks )
+                                                             : parallel::make_chunks( p.schedule, p.pool, size ) );
+         if( p.aligned )
+            chunks = parallel::align_chunks( chunks, [&]( size_t i ){ return element_address( shapes, i ); } );
+
+         parallel::ChunkScheduler scheduler( p.schedule, p.pool, std::move(chunks) );
+
+         return context.runner.run( n, [&]{
+            context.translations.for_each( [&]( const Vector& v ){
+               scheduler.run( [&]( const parallel::Chunk& chunk ){
+                  translate_range( shapes, v, chunk.begin, chunk.end );
+                  if( p.costs != nullptr ) {
+                     double x( 0.0 );
+                     for( size_t i=chunk.begin; i<chunk.end; ++i ) {
+                        x = imbalance_work( x, (*p.costs)[i] );
+                     }
+                     const volatile double sink( x );
+                     static_cast<void>( sink );
+                  }
+               } );
+            } );
+         } );
+      }
+
+      // Runs the coroutine pipeline: the producer yields the translation vectors, the batcher
+      // accumulates K of them and the consumer applies every batch in one pass over the shapes,
+      // either as the sum of the batch or block by block in the order of the steps.
+      template< typename Shapes >
+      static Result run_batched( const std::string& n, const Context& context, Shapes& shapes )
+      {
+         const Batching& b( *context.batching );
+         const size_t size( context.specs.size() );
+
+         return context.runner.run( n, [&]{
+            for( std::span<const Vector> batch : pipeline::batches( context.translations.generate(), b.steps ) )
+            {
+               if( b.combine == pipeline::Combine::summed ) {
+                  translate_shapes( shapes, pipeline::sum( batch ) );
+                  continue;
+               }
+
+               for( size_t begin=0UL; begin<size; begin+=pipeline::block_shapes )
+               {
+                  const size_t end( std::min( begin+pipeline::block_shapes, size ) );
+                  for( const Vector& v : batch ) {
+                     translate_range( shapes, v, begin, end );
+                  }
+               }
+            }
+         } );
+      }
+
+      // Records every step in a lazy collection and reads the positions every interval steps and at
+      // the end of the run, which applies the pending translations. With the per_shape deferral every
+      // step only translates its subset of the shapes (lazy::for_each_subset()), which an interval
+      // of 0 translates immediately instead.
+      template< typename Shapes >
+      static Result run_deferred( const std::string& n, const Context& context, Shapes shapes )
+      {
+         const Lazy& l( *context.lazy );
+         const size_t size( context.specs.size() );
+
+         const auto apply = [size]( Shapes& s, const Vector& v, size_t begin, size_t end ){
+            if( begin == 0UL && end == size )
+               translate_shapes( s, v );
+            else
+               translate_range( s, v, begin, end );
+         };
+
+         if( l.interval == 0UL )
+         {
+            return context.runner.run( n, [&]{
+               size_t step( 0UL );
+               context.translations.for_each( [&]( const Vector& v ){
+                  lazy::for_each_subset( step++, size, [&]( size_t begin, size_t end ){
+                     apply( shapes, v, begin, end );
+                  } );
+               } );
+            } );
+         }
+
+         lazy::Collection<Shapes,Vector> collection( std::move(shapes), size );
+
+         return context.runner.run( n, [&]{
+            size_t step( 0UL );
+            context.translations.for_each( [&]( const Vector& v ){
+               if( l.deferral == lazy::Deferral::global ) {
+                  collection.translate( v );
+               }
+               else {
+                  lazy::for_each_subset( step++, size, [&]( size_t begin, size_t end ){
+                     collection.translate( v, begin, end );
+                  } );
+               }
+            }, l.interval, [&]{ collection.read( apply ); } );
+
+            collection.read( apply );
+         } );
+      }
+
+      // Returns the address of the shape with index i, i.e. of the object for containers of
+      // pointers, or nullptr if the container does not provide access by index.
+      template< typename Shapes >
+      static const void* element_address( Shapes& shapes, size_t i )
+      {
+         if constexpr( is_pointer_container<Shapes>::value )
+            return shapes[i].get();
+         else if constexpr( std::ranges::contiguous_range<Shapes> )
+            return &shapes[i];
+         else if constexpr( requires{ shapes.x.data(); } )
+            return &shapes.x[i];
+         else if constexpr( requires{ shapes.for_each( []( auto& ){}, i, i ); } ) {
+            const void* address{};
+            shapes.for_each( [&]( auto& shape ){ address = &shape; }, i, i+1UL );
+            return address;
+         }
+         else
+            return nullptr;
+      }
+
+      template< typename Shapes >
+      static void translate_range( Shapes& shapes, const Vector& v, size_t begin, size_t end )
+      {
+         if constexpr( requires{ translate( shapes, v, begin, end ); } )
+            translate( shapes, v, begin, end );
+         else
+            translate( std::span( shapes ).subspan( begin, end-begin ), v );
+      }
+
+      template< typename Shapes, typename = void >
+      struct is_pointer_container : public std::false_type
+      {};
+
+      template< typename Shapes >
+      struct is_pointer_container< Shapes, std::enable_if_t<
+         std::is_same< typename Shapes::value_type
+                     , std::unique_ptr< typename Shapes::value_type::element_type > >::value > >
+         : public std::true_type
+      {};
+
+      // Owner of the decoy allocations that scatter pointer-based shapes across the heap.
+      class Heap
+      {
+       public:
+         explicit Heap( unsigned int seed )
+            : rng_{ seed }
+         {}
+
+         // Reserves the decoys of the given number of calls to scatter().
+         void reserve( size_t scatters )
+         {
+            decoys_.reserve( 3UL * scatters );
+         }
+
+         // Allocates one to three decoys of 16 to 256 bytes and frees a random earlier decoy.
+         void scatter()
+         {
+            std::uniform_int_distribution<size_t> count( 1UL, 3UL );
+            std::uniform_int_distribution<size_t> size( 16UL, 256UL );
+
+            for( size_t i=count( rng_ ); i>0UL; --i ) {
+               decoys_.push_back( std::make_unique<char[]>( size( rng_ ) ) );
+            }
+
+            std::uniform_int_distribution<size_t> victim( 0UL, decoys_.size()-1UL );
+            decoys_[ victim( rng_ ) ].reset();
+         }
+
+         // Drops the freed decoys, such that replace() only frees live decoys.
+         void settle()
+         {
+            std::erase( decoys_, nullptr );
+         }
+
+         // Replaces one to three random decoys by decoys of 16 to 256 bytes, which frees as many
+         // decoys as it allocates.
+         void replace()
+         {
+            if( decoys_.empty() )
+               return;
+
+            std::uniform_int_distribution<size_t> count( 1UL, 3UL );
+            std::uniform_int_distribution<size_t> size( 16UL, 256UL );
+            std::uniform_int_distribution<size_t> victim( 0UL, decoys_.size()-1UL );
+
+            for( size_t i=count( rng_ ); i>0UL; --i ) {
+               decoys_[ victim( rng_ ) ] = std::make_unique<char[]>( size( rng_ ) );
+            }
+         }
+
+         // Frees and reallocates a tenth of the shapes (at least one) at random positions. The new
+         // shapes are moved to the current center of the shapes.
+         template< typename ShapeFactory, typename Shapes >
+         void churn( const ShapeFactory& make_shape, const ShapeSpecs& specs, Shapes& shapes
+                   , const Vector& center )
+         {
+            if( shapes.empty() )
+               return;
+
+            std::uniform_int_distribution<size_t> index( 0UL, shapes.size()-1UL );
+
+            for( size_t i=std::max( shapes.size() / 10UL, size_t{1UL} ); i>0UL; --i )
+            {
+               const size_t pos( index( rng_ ) );
+               replace();
+               shapes[pos] = make_shape( specs[pos] );
+               translate_range( shapes, center, pos, pos+1UL );
+            }
+         }
+
+         std::mt19937& rng() { return rng_; }
+
+       private:
+         std::mt19937 rng_;
+         std::vector< std::unique_ptr<char[]> > decoys_;
+      };
+
+      // Builds the shapes of a solution according to the allocation mode. For the fragmented
+      // modes the factory for single shapes is called once per shape, in random order and
+      // interleaved with decoy allocations, and the resulting pointers are assembled in the
+      // original order.
+      template< typename Factory, typename ShapeFactory >
+      static auto build( const Factory& factory, const ShapeFactory& make_shape, const ShapeSpecs& specs
+                       , const AllocationMode& alloc, Heap& heap )
+      {
+         using Shapes = decltype( factory( specs ) );
+
+         if constexpr( is_pointer_container<Shapes>::value )
+         {
+            static_assert( !std::is_null_pointer_v<ShapeFactory>
+                         , "Pointer-based solutions are registered with a factory for single shapes" );
+
+            if( alloc.kind != AllocationMode::fresh )
+            {
+               std::vector<size_t> order( specs.size() );
+               for( size_t i=0UL; i<order.size(); ++i ) {
+                  order[i] = i;
+               }
+               std::shuffle( order.begin(), order.end(), heap.rng() );
+
+               std::vector<typename Shapes::value_type> pointers( specs.size() );
+               heap.reserve( specs.size() );
+               for( size_t i : order ) {
+                  heap.scatter();
+                  pointers[i] = make_shape( specs[i] );
+               }
+               heap.settle();
+
+               Shapes shapes;
+               shapes.reserve( specs.size() );
+               for( auto& pointer : pointers ) {
+                  shapes.push_back( std::move( pointer ) );
+               }
+
+               return shapes;
+            }
+         }
+
+         return factory( specs );
+      }
+
+      template< template<size_t> class Shapes, typename Factory, size_t... Ks >
+      static void add_generated( std::map<size_t,RunFunction>& runs, Factory factory, std::index_sequence<Ks...> )
+      {
+         ( runs.emplace( Ks, make_generated_run<Shapes,Ks>( factory ) ), ... );
+      }
+
+      template< template<size_t> class Shapes, size_t K, typename Factory >
+      static RunFunction make_generated_run( Factory factory )
+      {
+         using Types = std::integral_constant<size_t,K>;
+         using Container = std::conditional_t< std::is_same_v<Shapes<K>,VectorOfShapes<K>>, void, Shapes<K> >;
+
+         if constexpr( std::is_invocable_v<const Factory&, const ShapeSpec&, Types> ) {
+            const auto make_shape = [factory]( const ShapeSpec& spec ){ return factory( spec, Types{} ); };
+            return make_run< std::decay_t<decltype(make_shape)>, Container >( make_shape );
+         }
+         else {
+            return make_run( [factory]( const ShapeSpecs& specs ){ return factory( specs, Types{} ); } );
+         }
+      }
+
+      // Runs the hand-written variant of the given solution.
+      Result run_solution( const Solution& solution, const Config& config, const Runner& runner
+                         , const ShapeSpecs& specs, const Translations<Vector>& translations
+                         , const Parallel* parallel = nullptr, const Batching* batching = nullptr
+                         , const Lazy* lazy = nullptr ) const
+      {
+         return run_variant( solution, solution.run, 2UL, config, runner, specs, translations, parallel, batching, lazy );
+      }
+
+      // Runs the given variant of a solution, i.e. either its hand-written variant or its generated
+      // variant for the given number of shape types.
+      Result run_variant( const Solution& solution, const RunFunction& run, size_t types
+                        , const Config& config, const Runner& runner
+                        , const ShapeSpecs& specs, const Translations<Vector>& translations
+                        , const Parallel* parallel = nullptr, const Batching* batching = nullptr
+                        , const Lazy* lazy = nullptr ) const
+      {
+         Result result( run( solution.name, Context{ config, runner, specs, translations, parallel, batching, lazy } ) );
+         result.label      = solution.label;
+         result.shapes     = specs.size();
+         result.steps      = translations.steps();
+         result.types      = types;
+         result.code_bytes = code_size( solution.scope, &run != &solution.run );
+
+         if( parallel != nullptr ) {
+            result.threads  = parallel->pool.size();
+            result.schedule = parallel->label();
+         }
+
+         if( batching != nullptr ) {
+            result.batch   = batching->steps;
+            result.combine = pipeline::to_string( batching->combine );
+         }
+
+         if( lazy != nullptr ) {
+            result.read_interval = lazy->interval;
+            result.deferral      = lazy::to_string( lazy->deferral );
+         }
+
+         return result;
+      }
+
+      std::vector<Result> run_single( const Config& config, const Runner& runner ) const
+      {
+         std::cout << "\n N: " << config.shapes << "  steps: " << config.steps
+                   << "  seed: " << config.seed << "  translations: " << to_string( config.translations )
+                   << "  order: " << to_string( config.order )
+                   << "  alloc: " << to_string( config.alloc )
+                   << "  vector: " << Vector::layout
+                   << "\n\n";
+
+         const ShapeSpecs specs( make_shape_specs( config.shapes, config.seed, config.order ) );
+         const Translations<Vector> translations( config.translations, config.steps, config.seed + 1U );
+
+         std::vector<Result> results;
+
+         for( const Solution& solution : solutions_ )
+         {
+            if( !config.selected( solution.name, solution.opt_in ) )
+               continue;
+
+            results.push_back( run_solution( solution, config, runner, specs, translations ) );
+            print( std::cout, results.back() );
+         }
+
+         std::cout << "\n";
+
+         return results;
+      }
+
+      // Runs every selected solution for a geometric sequence of shape counts. The number of steps
+      // is scaled such that every point performs roughly --shapes x --steps shape updates.
+      std::vector<Result> run_sweep( const Config& config, const Runner& runner ) const
+      {
+         const size_t work( std::max( config.shapes * config.steps, size_t{1UL} ) );
+         const std::vector<size_t> sizes( sweep_sizes( config.sweep_min, config.sweep_max, config.sweep_factor ) );
+
+         std::vector<const Solution*> selected;
+         for( const Solution& solution : solutions_ ) {
+            if( config.selected( solution.name, solution.opt_in ) )
+               selected.push_back( &solution );
+         }
+
+         std::cout << "\n Working-set sweep  N: " << config.sweep_min << ".." << config.sweep_max
+                   << " (x" << config.sweep_factor << ")  shape updates per point: " << work
+                   << "  seed: " << config.seed << "  translations: " << to_string( config.translations )
+                   << "  order: " << to_string( config.order )
+                   << "  alloc: " << to_string( config.alloc )
+                   << "  vector: " << Vector::layout
+                   << "\n " << cache_summary() << "\n\n";
+
+         std::vector< std::vector<Result> > table;
+
+         for( size_t N : sizes )
+         {
+            const size_t steps( std::max( work / N, size_t{1UL} ) );
+            const ShapeSpecs specs( make_shape_specs( N, config.seed, config.order ) );
+            const Translations<Vector> translations( config.translations, steps, config.seed + 1U );
+
+            table.emplace_back();
+            for( const Solution* solution : selected )
+            {
+               table.back().push_back( run_solution( *solution, config, runner, specs, translations ) );
+               std::cerr << "." << std::flush;
+            }
+         }
+
+         std::cerr << "\n";
+
+         std::ostringstream header;
+         header << std::setw( 12 ) << "N" << std::setw( 7 ) << "level";
+
+         std::vector<std::string> keys;
+         for( size_t N : sizes ) {
+            std::ostringstream key;
+            key << std::setw( 12 ) << N << std::setw( 7 ) << cache_level( N * value_shape_bytes<Vector> );
+            keys.push_back( key.str() );
+         }
+
+         const std::string title( "Median ns per shape update (level: smallest cache holding N x "
+                                + std::to_string( value_shape_bytes<Vector> ) + " bytes, the size of a"
+                                + " value-based shape; pointer-based and SoA solutions differ)" );
+
+         print_table( std::cout, title, header.str(), keys, selected, table );
+
+         return flatten( table );
+      }
+
+      // Runs the generated variant of every selected solution for each requested number of shape
+      // types K on --shapes shapes whose types are drawn from [0,K) in the requested order.
+      std::vector<Result> run_types( const Config& config, const Runner& runner ) const
+      {
+         std::vector<const Solution*> selected;
+         for( const Solution& solution : solutions_ ) {
+            if( config.selected( solution.name, solution.opt_in ) && !solution.generated.empty() )
+               selected.push_back( &solution );
+         }
+
+         std::cout << "\n Shape type scaling  N: " << config.shapes << "  steps: " << config.steps
+                   << "  seed: " << config.seed << "  translations: " << to_string( config.translations )
+                   << "  order: " << to_string( config.order )
+                   << "  alloc: " << to_string( config.alloc )
+                   << "  vector: " << Vector::layout
+                   << "\n\n";
+
+         const Translations<Vector> translations( config.translations, config.steps, config.seed + 1U );
+
+         std::vector< std::vector<Result> > table;
+         std::vector<std::string> keys;
+
+         for( size_t K : config.types )
+         {
+            const ShapeSpecs specs( make_shape_specs( config.shapes, config.seed, config.order, K ) );
+
+            table.emplace_back();
+            for( const Solution* solution : selected )
+            {
+               table.back().push_back( run_variant( *solution, solution->generated.at( K ), K, config, runner, specs, translations ) );
+               std::cerr << "." << std::flush;
+            }
+
+            std::ostringstream key;
+            key << std::setw( 12 ) << K;
+            keys.push_back( key.str() );
+         }
+
+         std::cerr << "\n";
+
+         std::ostringstream header;
+         header << std::setw( 12 ) << "K";
+
+         print_table( std::cout, "Median ns per shape update for K shape types", header.str(), keys, selected, table );
+
+         return flatten( table );
+      }
+
+      // Runs every selected solution with each requested number of threads and schedule on the
+      // same shapes. Reports the median per thread count and schedule as well as the speedup and
+      // the parallel efficiency relative to the first thread count of the same schedule.
+      std::vector<Result> run_threads( const Config& config, const Runner& runner ) const
+      {
+         std::vector<const Solution*> selected;
+         for( const Solution& solution : solutions_ ) {
+            if( config.selected( solution.name, solution.opt_in ) )
+               selected.push_back( &solution );
+         }
+
+         std::cout << "\n Thread scaling  N: " << config.shapes << "  steps: " << config.steps
+                   << "  seed: " << config.seed << "  translations: " << to_string( config.translations )
+                   << "  order: " << to_string( config.order )
+                   << "  alloc: " << to_string( config.alloc )
+                   << "  vector: " << Vector::layout
+                   << "\n hardware threads: " << std::thread::hardware_concurrency();
+         if( config.imbalance > 0UL )
+            std::cout << "  imbalance: squares cost " << config.imbalance << "x";
+         std::cout << "\n\n";
+
+         if( !parallel::parallel_algorithms &&
+             std::find( config.schedules.begin(), config.schedules.end(), parallel::Schedule::par_unseq ) != config.schedules.end() )
+            std::cerr << " Warning: no parallel algorithms available, par_unseq runs serially on the calling thread\n";
+
+         const bool oversubscribed( warn_oversubscription( std::cerr, config.threads ) );
+
+         const ShapeSpecs specs( make_shape_specs( config.shapes, config.seed, config.order ) );
+         const Translations<Vector> translations( config.translations, config.steps, config.seed + 1U );
+         const std::vector<size_t> costs( make_costs( specs, config.imbalance ) );
+
+         // One table per schedule with one row per number of threads.
+         std::vector< std::vector< std::vector<Result> > > tables( config.schedules.size() );
+         std::vector<std::string> keys;
+
+         for( size_t T : config.threads )
+         {
+            parallel::ThreadPool pool( T );
+
+            for( size_t s=0UL; s<config.schedules.size(); ++s )
+            {
+               const Parallel p{ pool, config.schedules[s], config.imbalance > 0UL ? &costs : nullptr, 0UL, config.aligned_chunks };
+
+               tables[s].emplace_back();
+               for( const Solution* solution : selected )
+               {
+                  tables[s].back().push_back( run_solution( *solution, config, runner, specs, translations, &p ) );
+                  std::cerr << "." << std::flush;
+               }
+            }
+
+            std::ostringstream key;
+            key << std::setw( 12 ) << T;
+            keys.push_back( key.str() );
+         }
+
+         std::cerr << "\n";
+
+         std::ostringstream header;
+         header << std::setw( 12 ) << "threads";
+
+         std::vector<Result> results;
+
+         for( size_t s=0UL; s<config.schedules.size(); ++s )
+         {
+            const bool serial( config.schedules[s] == parallel::Schedule::par_unseq && !parallel::parallel_algorithms );
+            const std::string schedule( parallel::to_string( config.schedules[s] ) + ( config.aligned_chunks ? " (aligned chunks)" : "" )
+                                                                                 + ( serial ? " (serial fallback)" : "" ) );
+
+            print_table( std::cout, "Median ns per shape update, schedule " + schedule
+                       , header.str(), keys, selected, tables[s], !oversubscribed );
+
+            // A serial schedule has no speedup to report.
+            if( !serial ) {
+               print_scaling( std::cout, "Speedup and efficiency over " + std::to_string( config.threads.front() )
+                                         + " thread(s), schedule " + schedule
+                            , header.str(), keys, config.threads, selected, tables[s] );
+            }
+
+            const std::vector<Result> flat( flatten( tables[s] ) );
+            results.insert( results.end(), flat.begin(), flat.end() );
+         }
+
+         return results;
+      }
+
+      // Runs every selected solution with each requested number of threads on chunks of a single
+      // shape, which the static schedule deals out round-robin, i.e. neighbouring shapes are
+      // translated by different threads. Every run is repeated with the chunk boundaries moved to
+      // cache line boundaries. The ratio of the two contains the cost of false sharing and the
+      // overhead of the smaller chunks; the latter is removed by normalizing with the ratio of one
+      // thread, where no false sharing is possible.
+      std::vector<Result> run_false_sharing( const Config& config, const Runner& runner ) const
+      {
+         std::vector<const Solution*> selected;
+         for( const Solution& solution : solutions_ ) {
+            if( config.selected( solution.name, solution.opt_in ) )
+               selected.push_back( &solution );
+         }
+
+         std::cout << "\n False sharing  N: " << config.shapes << "  steps: " << config.steps
+                   << "  seed: " << config.seed << "  translations: " << to_string( config.translations )
+                   << "  order: " << to_string( config.order )
+                   << "  alloc: " << to_string( config.alloc )
+                   << "  vector: " << Vector::layout
+                   << "\n hardware threads: " << std::thread::hardware_concurrency() << "\n\n";
+
+         const bool oversubscribed( warn_oversubscription( std::cerr, config.threads ) );
+
+         const ShapeSpecs specs( make_shape_specs( config.shapes, config.seed, config.order ) );
+         const Translations<Vector> translations( config.translations, config.steps, config.seed + 1U );
+
+         // Two rows per number of threads: interleaved and aligned.
+         std::vector< std::vector<Result> > table;
+         std::vector<std::string> keys;
+
+         for( size_t T : config.threads )
+         {
+            parallel::ThreadPool pool( T );
+
+            for( bool aligned : { false, true } )
+            {
+               const Parallel p{ pool, parallel::Schedule::static_chunks, nullptr, specs.size(), aligned };
+
+               table.emplace_back();
+               for( const Solution* solution : selected )
+               {
+                  table.back().push_back( run_solution( *solution, config, runner, specs, translations, &p ) );
+                  std::cerr << "." << std::flush;
+               }
+
+               std::ostringstream key;
+               key << std::setw( 12 ) << T << std::setw( 13 ) << ( aligned ? "aligned" : "interleaved" );
+               keys.push_back( key.str() );
+            }
+         }
+
+         std::cerr << "\n";
+
+         std::ostringstream header;
+         header << std::setw( 12 ) << "threads" << std::setw( 13 ) << "boundaries";
+
+         print_table( std::cout, "Median ns per shape update, one-shape chunks dealt out round-robin"
+                    , header.str(), keys, selected, table, !oversubscribed );
+
+         print_false_sharing( std::cout, config.threads, selected, table );
+
+         return flatten( table );
+      }
+
+      // Runs every selected solution with the per-step loop and with the batched pipeline for every
+      // requested number of steps per batch and consumer, and prints the speedup over the loop.
+      std::vector<Result> run_batching( const Config& config, const Runner& runner ) const
+      {
+         std::vector<const Solution*> selected;
+         for( const Solution& solution : solutions_ ) {
+            if( config.selected( solution.name, solution.opt_in ) )
+               selected.push_back( &solution );
+         }
+
+         std::cout << "\n Batched steps  N: " << config.shapes << "  steps: " << config.steps
+                   << "  seed: " << config.seed << "  translations: " << to_string( config.translations )
+                   << "  order: " << to_string( config.order )
+                   << "  alloc: " << to_string( config.alloc )
+                   << "  vector: " << Vector::layout
+                   << "\n\n";
+
+         const ShapeSpecs specs( make_shape_specs( config.shapes, config.seed, config.order ) );
+         const Translations<Vector> translations( config.translations, config.steps, config.seed + 1U );
+
+         // The first row is the per-step loop, followed by one row per batch size and consumer.
+         std::vector< std::vector<Result> > table( 1UL );
+         std::vector<std::string> keys;
+
+         for( const Solution* solution : selected )
+         {
+            table.front().push_back( run_solution( *solution, config, runner, specs, translations ) );
+            std::cerr << "." << std::flush;
+         }
+
+         std::ostringstream loop;
+         loop << std::setw( 12 ) << 1 << std::setw( 12 ) << "per-step";
+         keys.push_back( loop.str() );
+
+         for( size_t K : config.batch )
+         {
+            for( pipeline::Combine combine : config.combines )
+            {
+               const Batching b{ K, combine };
+
+               table.emplace_back();
+               for( const Solution* solution : selected )
+               {
+                  table.back().push_back( run_solution( *solution, config, runner, specs, translations, nullptr, &b ) );
+                  std::cerr << "." << std::flush;
+               }
+
+               std::ostringstream key;
+               key << std::setw( 12 ) << K << std::setw( 12 ) << pipeline::to_string( combine );
+               keys.push_back( key.str() );
+            }
+         }
+
+         std::cerr << "\n";
+
+         std::ostringstream header;
+         header << std::setw( 12 ) << "batch" << std::setw( 12 ) << "combine";
+
+         print_table( std::cout, "Median ns per shape update", header.str(), keys, selected, table );
+         print_speedup( std::cout, "Speedup over the per-step loop", header.str(), keys, selected, table );
+
+         return flatten( table );
+      }
+
+      // Runs every selected solution with the per-step loop and with deferred translations for every
+      // requested read interval, once per deferral, and prints the speedup over the loop. The global
+      // deferral is compared with the loop over all shapes, the per_shape deferral with the loop over
+      // the same subsets of the shapes.
+      std::vector<Result> run_lazy( const Config& config, const Runner& runner ) const
+      {
+         std::vector<const Solution*> selected;
+         for( const Solution& solution : solutions_ ) {
+            if( config.selected( solution.name, solution.opt_in ) )
+               selected.push_back( &solution );
+         }
+
+         std::cout << "\n Deferred translation  N: " << config.shapes << "  steps: " << config.steps
+                   << "  seed: " << config.seed << "  translations: " << to_string( config.translations )
+                   << "  order: " << to_string( config.order )
+                   << "  alloc: " << to_string( config.alloc )
+                   << "  vector: " << Vector::layout
+                   << "\n\n";
+
+         const ShapeSpecs specs( make_shape_specs( config.shapes, config.seed, config.order ) );
+         const Translations<Vector> translations( config.translations, config.steps, config.seed + 1U );
+
+         std::ostringstream header;
+         header << std::setw( 12 ) << "read every" << std::setw( 12 ) << "deferral";
+
+         std::vector<Result> results;
+
+         for( lazy::Deferral deferral : { lazy::Deferral::global, lazy::Deferral::per_shape } )
+         {
+            // The first row is the per-step loop, followed by one row per read interval.
+            std::vector< std::vector<Result> > table( 1UL );
+            std::vector<std::string> keys;
+
+            const Lazy immediate{ 0UL, deferral };
+
+            for( const Solution* solution : selected )
+            {
+               table.front().push_back( deferral == lazy::Deferral::global
+                                      ? run_solution( *solution, config, runner, specs, translations )
+                                      : run_solution( *solution, config, runner, specs, translations, nullptr, nullptr, &immediate ) );
+               std::cerr << "." << std::flush;
+            }
+
+            std::ostringstream loop;
+            loop << std::setw( 12 ) << 1 << std::setw( 12 ) << "none";
+            keys.push_back( loop.str() );
+
+            for( size_t R : config.lazy )
+            {
+               const Lazy l{ R, deferral };
+
+               table.emplace_back();
+               for( const Solution* solution : selected )
+               {
+                  table.back().push_back( run_solution( *solution, config, runner, specs, translations, nullptr, nullptr, &l ) );
+                  std::cerr << "." << std::flush;
+               }
+
+               std::ostringstream key;
+               key << std::setw( 12 ) << R << std::setw( 12 ) << lazy::to_string( deferral );
+               keys.push_back( key.str() );
+            }
+
+            std::cerr << "\n";
+
+            const std::string caption( deferral == lazy::Deferral::global
+                                     ? "every step translates all shapes"
+                                     : "every step translates a quarter of the shapes" );
+
+            print_table( std::cout, "Median ns per shape and step, " + caption, header.str(), keys, selected, table );
+            print_speedup( std::cout, "Speedup over the per-step loop, " + caption, header.str(), keys, selected, table );
+
+            const std::vector<Result> flat( flatten( table ) );
+            results.insert( results.end(), flat.begin(), flat.end() );
+         }
+
+         return results;
+      }
+
+      static std::vector<Result> flatten( const std::vector< std::vector<Result> >& table )
+      {
+         std::vector<Result> results;
+         for( const std::vector<Result>& row : table ) {
+            results.insert( results.end(), row.begin(), row.end() );
+         }
+         return results;
+      }
+
+      Metadata metadata( const Config& config ) const
+      {
+         Metadata meta{};
+         meta.binary       = binary_;
+         meta.compiler     = compiler_version();
+         meta.flags        = compile_flags();
+         meta.cpu          = cpu_model();
+         meta.timestamp    = utc_timestamp();
+         meta.seed         = config.seed;
+         meta.translations = to_string( config.translations );
+         meta.order        = to_string( config.order );
+         meta.alloc        = to_string( config.alloc );
+         meta.layout       = Vector::layout;
+         meta.imbalance    = config.imbalance;
+         meta.warmup       = config.warmup;
+
+         return meta;
+      }
+
+      bool write_results( const Config& config, const std::vector<Result>& results ) const
+      {
+         const Metadata meta( metadata( config ) );
+
+         const std::pair<const std::string&, void(*)( std::ostream&, const Metadata&, const std::vector<Result>& )> outputs[] = {
+            { config.csv,  &write_csv  },
+            { config.json, &write_json }
+         };
+
+         bool success( true );
+
+         for( const auto& output : outputs )
+         {
+            if( output.first.empty() )
+               continue;
+
+            std::ofstream file( output.first );
+            output.second( file, meta, results );
+
+            if( !file ) {
+               std::cerr << " Failed to write " << output.first << "\n";
+               success = false;
+            }
+         }
+
+         return success;
+      }
+
+      // Prints the median ns per shape update of every solution and row, and marks the rows whose
+      // fastest solution differs from the previous row, unless crossover is false.
+      static void print_table( std::ostream& os, const std::string& caption, const std::string& header
+                             , const std::vector<std::string>& keys, const std::vector<const Solution*>& selected
+                             , const std::vector< std::vector<Result> >& table, bool crossover = true )
+      {
+         const auto flags( os.flags() );
+         const auto precision( os.precision() );
+
+         os << " " << caption << "\n\n" << header;
+         for( const Solution* solution : selected ) {
+            os << "  " << std::setw( static_cast<int>( std::max( solution->name.size(), size_t{8UL} ) ) ) << solution->name;
+         }
+         os << "  fastest\n";
+
+         std::string previous;
+
+         for( size_t r=0UL; r<table.size(); ++r )
+         {
+            const std::vector<Result>& row( table[r] );
+
+            if( row.empty() )
+               continue;
+
+            os << keys[r];
+
+            size_t best( 0UL );
+            for( size_t i=0UL; i<row.size(); ++i )
+            {
+               if( row[i].ns_per_shape() < row[best].ns_per_shape() )
+                  best = i;
+
+               os << "  " << std::setw( static_cast<int>( std::max( selected[i]->name.size(), size_t{8UL} ) ) )
+                  << std::fixed << std::setprecision( 3 ) << row[i].ns_per_shape();
+            }
+
+            os << "  " << row[best].name;
+            if( crossover && !previous.empty() && previous != row[best].name )
+               os << "  <- crossover";
+            os << "\n";
+
+            previous = row[best].name;
+         }
+
+         os << "\n";
+
+         os.flags( flags );
+         os.precision( precision );
+      }
+
+      // Prints speedup and efficiency of every row with respect to the first row, whose results
+      // were measured with threads.front() threads.
+      static void print_scaling( std::ostream& os, const std::string& caption, const std::string& header
+                               , const std::vector<std::string>& keys, const std::vector<size_t>& threads
+                               , const std::vector<const Solution*>& selected
+                               , const std::vector< std::vector<Result> >& table )
+      {
+         const auto width = []( const Solution* solution ){
+            return static_cast<int>( std::max( solution->name.size(), size_t{11UL} ) );
+         };
+
+         os << " " << caption << "\n\n" << header;
+         for( const Solution* solution : selected ) {
+            os << "  " << std::setw( width( solution ) ) << solution->name;
+         }
+         os << "\n";
+
+         for( size_t r=0UL; r<table.size(); ++r )
+         {
+            os << keys[r];
+
+            for( size_t i=0UL; i<table[r].size(); ++i )
+            {
+               const double base( table.front()[i].ns_per_shape() );
+               const double ns( table[r][i].ns_per_shape() );
+
+               std::ostringstream entry;
+               if( base > 0.0 && ns > 0.0 ) {
+                  const double speedup( base / ns );
+                  const double efficiency( speedup * static_cast<double>( threads.front() ) / static_cast<double>( threads[r] ) );
+                  entry << std::fixed << std::setprecision( 2 ) << speedup << "x "
+                        << std::setw( 4 ) << std::setprecision( 0 ) << 100.0 * efficiency << "%";
+               }
+
+               os << "  " << std::setw( width( selected[i] ) ) << entry.str();
+            }
+
+            os << "\n";
+         }
+
+         os << "\n";
+      }
+
+      // Prints the speedup of every row with respect to the first row.
+      static void print_speedup( std::ostream& os, const std::string& caption, const std::string& header
+                               , const std::vector<std::string>& keys, const std::vector<const Solution*>& selected
+                               , const std::vector< std::vector<Result> >& table )
+      {
+         const auto width = []( const Solution* solution ){
+            return static_cast<int>( std::max( solution->name.size(), size_t{8UL} ) );
+         };
+
+         os << " " << caption << "\n\n" << header;
+         for( const Solution* solution : selected ) {
+            os << "  " << std::setw( width( solution ) ) << solution->name;
+         }
+         os << "\n";
+
+         for( size_t r=0UL; r<table.size(); ++r )
+         {
+            os << keys[r];
+
+            for( size_t i=0UL; i<table[r].size(); ++i )
+            {
+               const double base( table.front()[i].ns_per_shape() );
+               const double ns( table[r][i].ns_per_shape() );
+
+               std::ostringstream entry;
+               if( base > 0.0 && ns > 0.0 )
+                  entry << std::fixed << std::setprecision( 2 ) << base / ns << "x";
+
+               os << "  " << std::setw( width( selected[i] ) ) << entry.str();
+            }
+
+            os << "\n";
+         }
+
+         os << "\n";
+      }
+
+      // Prints the ratio interleaved/aligned of every number of threads (two consecutive rows of the
+      // table) relative to the ratio of one thread, i.e. the slowdown caused by false sharing.
+      static void print_false_sharing( std::ostream& os, const std::vector<size_t>& threads
+                                     , const std::vector<const Solution*>& selected
+                                     , const std::vector< std::vector<Result> >& table )
+      {
+         const auto width = []( const Solution* solution ){
+            return static_cast<int>( std::max( solution->name.size(), size_t{8UL} ) );
+         };
+
+         const auto ratio = [&]( size_t r, size_t i ){
+            const double aligned( table[2UL*r+1UL][i].ns_per_shape() );
+            return aligned > 0.0 ? table[2UL*r][i].ns_per_shape() / aligned : 0.0;
+         };
+
+         const size_t one( static_cast<size_t>( std::find( threads.begin(), threads.end(), 1UL ) - threads.begin() ) );
+
+         const auto flags( os.flags() );
+         const auto precision( os.precision() );
+
+         os << " False sharing penalty (interleaved / aligned, relative to 1 thread)\n\n" << std::setw( 12 ) << "threads";
+         for( const Solution* solution : selected ) {
+            os << "  " << std::setw( width( solution ) ) << solution->name;
+         }
+         os << "\n";
+
+         for( size_t r=0UL; r<threads.size(); ++r )
+         {
+            os << std::setw( 12 ) << threads[r];
+
+            for( size_t i=0UL; i<selected.size(); ++i )
+            {
+               std::ostringstream entry;
+               if( ratio( one, i ) > 0.0 && ratio( r, i ) > 0.0 )
+                  entry << std::fixed << std::setprecision( 2 ) << ratio( r, i ) / ratio( one, i ) << "x";
+               os << "  " << std::setw( width( selected[i] ) ) << entry.str();
+            }
+
+            os << "\n";
+         }
+
+         os << "\n";
+
+         os.flags( flags );
+         os.precision( precision );
+      }
+
+      bool compare_baseline( const Config& config, const std::vector<Result>& results ) const
+      {
+         std::ifstream file( config.baseline );
+
+         if( !file ) {
+            std::cerr << " Failed to open baseline " << config.baseline << "\n";
+            return false;
+         }
+
+         std::vector<Comparison> comparisons;
+
+         try {
+            comparisons = compare( metadata( config ), results, read_baseline( file ), config.threshold, config.alpha );
+         }
+         catch( const std::runtime_error& ex ) {
+            std::cerr << " " << ex.what() << "\n";
+            return false;
+         }
+
+         print( std::cout, comparisons );
+
+         // A baseline without records for the selected solutions must not pass the comparison.
+         const size_t missing( static_cast<size_t>( std::count_if( comparisons.begin(), comparisons.end(), []( const Comparison& c ){
+            return c.missing;
+         } ) ) );
+
+         if( comparisons.empty() || missing > 0UL ) {
+            std::cerr << " Baseline " << config.baseline << " lacks records for "
+                      << ( comparisons.empty() ? std::string( "all results" ) : std::to_string( missing ) + " result(s)" ) << "\n";
+            return false;
+         }
+
+         // With too few repetitions no difference can be significant and the gate would always pass.
+         const auto blind( std::find_if( comparisons.begin(), comparisons.end(), [&]( const Comparison& c ){
+            return c.min_p >= config.alpha;
+         } ) );
+
+         if( blind != comparisons.end() ) {
+            std::cerr << " The regression gate cannot fire: with " << blind->baseline_samples << " baseline and "
+                      << blind->current_samples << " current repetitions of " << blind->solution
+                      << " the smallest reachable p is " << blind->min_p << ", not below --alpha=" << config.alpha
+                      << ". Increase --repetitions of the baseline and this run.\n";
+            return false;
+         }
+
+         return std::none_of( comparisons.begin(), comparisons.end(), []( const Comparison& c ){
+            return c.regression;
+         } );
+      }
+
+      std::string binary_;
+      std::vector<Solution> solutions_;
+   };
+   //**********************************************************************************************
+
+} // namespace benchmark
+
+#endif
@@ -0,0 +1,189 @@
+/**************************************************************************************************
+*
+* \file CodeSize.hpp
+* \brief C++ Training - Machine code size of the solutions of the design pattern benchmarks
+*
+* Copyright (C) 2015-2020 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef CODESIZE_HPP
+#define CODESIZE_HPP
+
+#include <cctype>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && defined(__ELF__)
+#  include <cxxabi.h>
+#  include <elf.h>
+#endif
+
+
+namespace benchmark {
+
+   //**********************************************************************************************
+   // The demangled names and sizes of all functions in the symbol table of the running program.
+   // The list is empty if the symbol table cannot be read (non-ELF platform, stripped binary).
+   inline const std::vector< std::pair<std::string,size_t> >& function_symbols()
+   {
+      static const std::vector< std::pair<std::string,size_t> > symbols = []
+      {
+         std::vector< std::pair<std::string,size_t> > result;
+
+#if defined(__linux__) && defined(__ELF__) && defined(__LP64__)
+         std::ifstream file( "/proc/self/exe", std::ios::binary );
+         const std::vector<char> image( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+
+         if( image.size() < sizeof(Elf64_Ehdr) )
+            return result;
+
+         Elf64_Ehdr header;
+         std::memcpy( &header, image.data(), sizeof(header) );
+
+         if( std::memcmp( header.e_ident, ELFMAG, SELFMAG ) != 0 || header.e_ident[EI_CLASS] != ELFCLASS64 ||
+             header.e_shoff + header.e_shnum * sizeof(Elf64_Shdr) > image.size() )
+            return result;
+
+         const auto section = [&]( size_t i ){
+            Elf64_Shdr s;
+            std::memcpy( &s, image.data() + header.e_shoff + i*sizeof(Elf64_Shdr), sizeof(s) );
+            return s;
+         };
+
+         for( size_t i=0UL; i<header.e_shnum; ++i )
+         {
+            const Elf64_Shdr symtab( section( i ) );
+            if( symtab.sh_type != SHT_SYMTAB || symtab.sh_link >= header.e_shnum )
+               continue;
+
+            const Elf64_Shdr strtab( section( symtab.sh_link ) );
+            if( symtab.sh_offset + symtab.sh_size > image.size() || strtab.sh_offset + strtab.sh_size > image.size() )
+               continue;
+
+            for( size_t j=0UL; j<symtab.sh_size/sizeof(Elf64_Sym); ++j )
+            {
+               Elf64_Sym symbol;
+               std::memcpy( &symbol, image.data() + symtab.sh_offset + j*sizeof(Elf64_Sym), sizeof(symbol) );
+
+               if( ELF64_ST_TYPE( symbol.st_info ) != STT_FUNC || symbol.st_size == 0U || symbol.st_name >= strtab.sh_size )
+                  continue;
+
+               const char* name( image.data() + strtab.sh_offset + symbol.st_name );
+
+               int status( 0 );
+               char* demangled( abi::__cxa_demangle( name, nullptr, nullptr, &status ) );
+               result.emplace_back( status == 0 ? demangled : name, symbol.st_size );
+               std::free( demangled );
+            }
+         }
+#endif
+
+         return result;
+      }();
+
+      return symbols;
+   }
+
+   // The entry point of the benchmark harness into the translate() function of a solution. It is
+   // never inlined, such that the code of a solution that is inlined into its caller (e.g. the
+   // strategy of policy_solution) stays in this function, whose template arguments name the
+   // types of the solution. Solutions without a translate() for their container translate a
+   // std::span of it.
+   template< typename Shapes, typename Vector >
+   [[gnu::noinline]] void translate_shapes( Shapes& shapes, const Vector& v )
+   {
+      if constexpr( requires{ translate( shapes, v ); } )
+         translate( shapes, v );
+      else
+         translate( std::span( shapes ), v );
+   }
+
+   // Returns the qualified name of the function with the given demangled signature, i.e. the part
+   // in front of the parameter list without the return type of a function template specialization
+   // (e.g. "ns::f<int>" for "void ns::f<int>(int)").
+   inline std::string qualified_name( const std::string& signature )
+   {
+      size_t begin( 0UL );
+      size_t depth( 0UL );
+
+      for( size_t i=0UL; i<signature.size(); ++i )
+      {
+         const char c( signature[i] );
+
+         if( c == '<' )
+            ++depth;
+         else if( c == '>' && depth > 0UL )
+            --depth;
+         else if( depth == 0UL && c == ' ' )
+            begin = i+1UL;
+         else if( depth == 0UL && c == '(' && i > begin )
+            return signature.substr( begin, i-begin );
+      }
+
+      return signature.substr( begin );
+   }
+
+   // Returns the total size in bytes of all functions whose qualified name lies in the given
+   // namespace of a solution, plus the instantiations of translate_shapes() for the solution's
+   // types, which hold the code of the solution inlined by the harness. Other instantiations of
+   // foreign templates for the solution's types (e.g. std::vector<solution::Shape>, or the rest
+   // of the benchmark harness) are not counted. With generated, only functions involving the
+   // solution's generated namespace are counted (all K together), otherwise these are excluded.
+   // Code that has been inlined into other functions is attributed to these functions. Returns 0
+   // if the size is unknown.
+   inline size_t code_size( const std::string& scope, bool generated )
+   {
+      const std::string prefix( scope + "::" );
+      const std::string nested( prefix + "generated::" );
+      const std::string entry( "benchmark::translate_shapes<" );
+
+      // The scope must not be the tail of a longer identifier (e.g. foo_solution:: in bar_foo_solution::).
+      const auto is_identifier = []( char c ){
+         return std::isalnum( static_cast<unsigned char>( c ) ) || c == '_';
+      };
+
+      const auto contains = [&]( const std::string& name, const std::string& what ){
+         for( size_t pos=name.find( what ); pos!=std::string::npos; pos=name.find( what, pos+1UL ) ) {
+            if( pos == 0UL || !is_identifier( name[pos-1UL] ) )
+               return true;
+         }
+         return false;
+      };
+
+      // A function of the solution with any generated type of the solution (e.g. a template of the
+      // solution's namespace instantiated for a generated type) belongs to the generated solution.
+      const auto matches = [&]( const std::string& name ){
+         const std::string qualified( qualified_name( name ) );
+
+         if( qualified.compare( 0UL, prefix.size(), prefix ) != 0 &&
+             !( qualified.compare( 0UL, entry.size(), entry ) == 0 && contains( qualified, prefix ) ) )
+            return false;
+
+         return generated == contains( name, nested );
+      };
+
+      size_t bytes( 0UL );
+
+      for( const auto& symbol : function_symbols() ) {
+         if( matches( symbol.first ) )
+            bytes += symbol.second;
+      }
+
+      return bytes;
+   }
+   //**********************************************************************************************
+
+} // namespace benchmark
+
+#endif
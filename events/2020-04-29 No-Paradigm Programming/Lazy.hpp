@@ -0,0 +1,175 @@
+/**************************************************************************************************
+*
+* \file Lazy.hpp
+* \brief C++ Training - Deferred translation of shape collections for the design pattern benchmarks
+*
+* Copyright (C) 2015-2020 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef LAZY_HPP
+#define LAZY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace lazy {
+
+   //**********************************************************************************************
+   // The ways the translations are recorded until the positions are read:
+   //  - global:    every step translates all shapes and adds its vector to one pending translation,
+   //               i.e. O(1) per step
+   //  - per_shape: every step translates a subset of the shapes (see for_each_subset()) and adds
+   //               its vector to the pending offsets of these shapes, i.e. O(L) vector additions
+   //               per step for a subset of L shapes, but without any dispatch per shape
+   enum class Deferral
+   {
+      global,
+      per_shape
+   };
+
+   inline std::string to_string( Deferral deferral )
+   {
+      switch( deferral ) {
+         case Deferral::global:    return "global";
+         case Deferral::per_shape: return "per-shape";
+      }
+      return "";
+   }
+
+   // The subset of the shapes translated by step s with the per_shape deferral: a contiguous range
+   // of a quarter of the shapes (at least one), whose start moves by subset_stride shapes with every
+   // step and which wraps around the end. fn( begin, end ) is called for one or two ranges. Shapes
+   // translated by the same steps have the same pending offset, i.e. the offsets of S steps form at
+   // most 2S+1 runs of equal offsets.
+   constexpr size_t subset_divisor = 4UL;
+   constexpr size_t subset_stride  = 40503UL;
+
+   template< typename Fn >
+   void for_each_subset( size_t step, size_t size, Fn&& fn )
+   {
+      if( size == 0UL )
+         return;
+
+      const size_t length( std::max( size / subset_divisor, size_t{1UL} ) );
+      const size_t begin( ( step % size ) * ( subset_stride % size ) % size );
+      const size_t end( begin + length );
+
+      if( end <= size ) {
+         fn( begin, end );
+      }
+      else {
+         fn( begin, size );
+         fn( 0UL, end - size );
+      }
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // A shape collection whose translations are deferred until the positions are read. Since
+   // translations are additive, all pending translations of a shape are applied as their sum, such
+   // that S steps between two reads cost O(S + N) instead of O(S x N) shape updates. Per-shape
+   // translations of L shapes per step still cost O(S x L + N) vector additions, but only O(N)
+   // shape updates. The positions differ from the immediately translated shapes by the rounding of
+   // the sums.
+   //
+   // The shapes are only accessible via read(), which first applies the pending translations in
+   // one pass over the shapes via the given function apply( shapes, v, begin, end ), which must
+   // translate the shapes [begin,end) by v. Neighbouring shapes with the same pending offset are
+   // translated by a single call.
+   template< typename Shapes, typename Vector >
+   class Collection
+   {
+    public:
+      Collection( Shapes shapes, size_t size )
+         : shapes_{ std::move(shapes) }
+         , size_{ size }
+      {}
+
+      void translate( const Vector& v )
+      {
+         global_ = global_ + v;
+      }
+
+      void translate( const Vector& v, size_t begin, size_t end )
+      {
+         if( offsets_.empty() )
+            offsets_.resize( size_ );
+
+         for( size_t i=begin; i<end; ++i ) {
+            offsets_[i] = offsets_[i] + v;
+         }
+
+         pending_ = true;
+      }
+
+      // Returns the shapes with all pending translations applied.
+      template< typename Apply >
+      const Shapes& read( Apply&& apply )
+      {
+         materialize( apply );
+         return shapes_;
+      }
+
+    private:
+      template< typename Apply >
+      void materialize( Apply& apply )
+      {
+         if( !pending_ )
+         {
+            if( !is_zero( global_ ) )
+               apply( shapes_, global_, 0UL, size_ );
+         }
+         else
+         {
+            for( size_t begin=0UL; begin<size_; )
+            {
+               size_t end( begin+1UL );
+               while( end < size_ && equal( offsets_[end], offsets_[begin] ) ) {
+                  ++end;
+               }
+
+               const Vector v( global_ + offsets_[begin] );
+               if( !is_zero( v ) )
+                  apply( shapes_, v, begin, end );
+
+               std::fill( offsets_.begin()+begin, offsets_.begin()+end, Vector{} );
+
+               begin = end;
+            }
+
+            pending_ = false;
+         }
+
+         global_ = Vector{};
+      }
+
+      static bool equal( const Vector& a, const Vector& b )
+      {
+         return a.x == b.x && a.y == b.y && a.z == b.z;
+      }
+
+      static bool is_zero( const Vector& v )
+      {
+         return equal( v, Vector{} );
+      }
+
+      Shapes shapes_;
+      size_t size_;
+      Vector global_{};
+      std::vector<Vector> offsets_;  // allocated by the first per-shape translation, then reused
+      bool pending_{ false };        // per-shape translations are pending
+   };
+   //**********************************************************************************************
+
+} // namespace lazy
+
+#endif
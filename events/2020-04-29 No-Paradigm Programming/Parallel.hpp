@@ -0,0 +1,468 @@
+/**************************************************************************************************
+*
+* \file Parallel.hpp
+* \brief C++ Training - Thread pool and parallel schedules for the design pattern benchmarks
+*
+* Copyright (C) 2015-2020 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The parallel algorithms are only used if requested via -DBENCHMARK_PARALLEL_STL, since libstdc++
+// runs them on TBB, which then has to be linked (-ltbb). The number of TBB threads is limited
+// explicitly.
+#if defined(BENCHMARK_PARALLEL_STL) && defined(__has_include)
+#  if __has_include(<execution>)
+#    include <execution>
+#  endif
+#endif
+
+#if defined(BENCHMARK_PARALLEL_STL) && defined(_PSTL_PAR_BACKEND_TBB)
+#  define BENCHMARK_PARALLEL_STL_TBB
+#  include <tbb/global_control.h>
+#endif
+
+
+namespace parallel {
+
+   //**********************************************************************************************
+   // The ways the chunks of a shape container are distributed to the threads of a pool:
+   //  - static_chunks: one contiguous chunk per thread, fixed in advance
+   //  - stealing:      several chunks per thread on a Chase-Lev deque per thread; a thread that
+   //                   runs out of chunks steals from the other threads
+   //  - par_unseq:     the chunks of stealing are handed to std::for_each with the par_unseq
+   //                   execution policy, i.e. to the threads of the standard library (limited to
+   //                   the size of the pool if the library uses TBB); only with
+   //                   -DBENCHMARK_PARALLEL_STL
+   enum class Schedule
+   {
+      static_chunks,
+      stealing,
+      par_unseq
+   };
+
+   inline std::string to_string( Schedule schedule )
+   {
+      switch( schedule ) {
+         case Schedule::static_chunks: return "static";
+         case Schedule::stealing:      return "stealing";
+         case Schedule::par_unseq:     return "par_unseq";
+      }
+      return "?";
+   }
+
+   // Whether the par_unseq schedule runs in parallel. Without BENCHMARK_PARALLEL_STL, without the
+   // parallel algorithms, or with the serial backend of libstdc++ (no TBB), std::for_each runs the
+   // chunks on the calling thread.
+#if defined(BENCHMARK_PARALLEL_STL) && defined(__cpp_lib_execution) && !defined(_PSTL_PAR_BACKEND_SERIAL)
+   constexpr bool parallel_algorithms = true;
+#else
+   constexpr bool parallel_algorithms = false;
+#endif
+
+   // Returns the schedules that are run if none are requested explicitly, i.e. all schedules that
+   // actually run in parallel.
+   inline std::vector<Schedule> default_schedules()
+   {
+      std::vector<Schedule> schedules{ Schedule::static_chunks, Schedule::stealing };
+      if( parallel_algorithms )
+         schedules.push_back( Schedule::par_unseq );
+      return schedules;
+   }
+
+   // The number of chunks per thread for the stealing and par_unseq schedules.
+   constexpr size_t chunks_per_thread = 8UL;
+
+   // The size of a cache line, i.e. the granularity of false sharing.
+   constexpr size_t cache_line = 64UL;
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // The half-open index range [begin,end) of a shape container.
+   struct Chunk
+   {
+      size_t begin;
+      size_t end;
+   };
+
+   // Splits [0,size) into count chunks whose sizes differ by at most one. Empty chunks are
+   // omitted, i.e. fewer than count chunks are returned if size < count.
+   inline std::vector<Chunk> make_chunks( size_t size, size_t count )
+   {
+      std::vector<Chunk> chunks;
+
+      count = std::max( std::min( count, size ), size_t{1UL} );
+
+      for( size_t i=0UL; i<count; ++i ) {
+         const Chunk chunk{ size * i / count, size * (i+1UL) / count };
+         if( chunk.end > chunk.begin )
+            chunks.push_back( chunk );
+      }
+
+      return chunks;
+   }
+
+   // Moves every boundary between two chunks forward to the next index whose element starts a
+   // cache line, such that no cache line is written by two chunks (if the elements are stored in
+   // index order). address( i ) returns the address of element i, or nullptr if it is unknown, in
+   // which case the boundary is kept. A boundary is also kept if no element within the next 64
+   // starts a cache line (e.g. for an odd element size), and dropped if no element behind it
+   // starts a cache line. Chunks that become empty are removed.
+   template< typename Address >
+   std::vector<Chunk> align_chunks( const std::vector<Chunk>& chunks, Address&& address )
+   {
+      if( chunks.empty() )
+         return chunks;
+
+      const size_t size( chunks.back().end );
+
+      std::vector<Chunk> aligned;
+      size_t begin( chunks.front().begin );
+
+      for( size_t c=1UL; c<chunks.size(); ++c )
+      {
+         const size_t boundary( chunks[c].begin );
+         size_t end( boundary );
+
+         for( size_t i=std::max( boundary, begin ); i<boundary+64UL; ++i )
+         {
+            // No cache line starts in front of the end: the rest belongs to the last chunk.
+            if( i == size ) {
+               end = begin;
+               break;
+            }
+
+            const void* p( address( i ) );
+            if( p == nullptr )
+               break;
+            if( reinterpret_cast<uintptr_t>( p ) % cache_line == 0UL ) {
+               end = i;
+               break;
+            }
+         }
+
+         if( end > begin ) {
+            aligned.push_back( Chunk{ begin, end } );
+            begin = end;
+         }
+      }
+
+      aligned.push_back( Chunk{ begin, size } );
+
+      return aligned;
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // A fixed set of threads that repeatedly execute the same job. run() calls the job with the
+   // index of every thread of the pool, the calling thread being thread 0, and returns once all
+   // threads have finished. A pool of size 1 does not start any thread. While the pool exists, the
+   // parallel algorithms of the standard library are limited to the same number of threads (if
+   // the library runs them on TBB).
+   class ThreadPool
+   {
+    public:
+      explicit ThreadPool( size_t threads )
+#if defined(BENCHMARK_PARALLEL_STL_TBB)
+         : limit_{ tbb::global_control::max_allowed_parallelism, std::max( threads, size_t{1UL} ) }
+#endif
+      {
+         for( size_t t=1UL; t<threads; ++t ) {
+            workers_.emplace_back( [this,t]{ work( t ); } );
+         }
+      }
+
+      ThreadPool( const ThreadPool& ) = delete;
+      ThreadPool& operator=( const ThreadPool& ) = delete;
+
+      ~ThreadPool()
+      {
+         {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            stop_ = true;
+         }
+         wake_.notify_all();
+
+         for( std::thread& worker : workers_ ) {
+            worker.join();
+         }
+      }
+
+      size_t size() const { return workers_.size() + 1UL; }
+
+      void run( const std::function<void(size_t)>& job )
+      {
+         {
+            std::lock_guard<std::mutex> lock( mutex_ );
+            job_ = &job;
+            pending_ = workers_.size();
+            ++generation_;
+         }
+         wake_.notify_all();
+
+         job( 0UL );
+
+         std::unique_lock<std::mutex> lock( mutex_ );
+         done_.wait( lock, [this]{ return pending_ == 0UL; } );
+         job_ = nullptr;
+      }
+
+    private:
+      void work( size_t index )
+      {
+         size_t generation( 0UL );
+
+         for( ;; )
+         {
+            const std::function<void(size_t)>* job{};
+            {
+               std::unique_lock<std::mutex> lock( mutex_ );
+               wake_.wait( lock, [&]{ return stop_ || generation_ != generation; } );
+               if( stop_ )
+                  return;
+               generation = generation_;
+               job = job_;
+            }
+
+            (*job)( index );
+
+            {
+               std::lock_guard<std::mutex> lock( mutex_ );
+               --pending_;
+            }
+            done_.notify_one();
+         }
+      }
+
+      std::vector<std::thread> workers_;
+      std::mutex mutex_;
+      std::condition_variable wake_;
+      std::condition_variable done_;
+      const std::function<void(size_t)>* job_{};
+      size_t generation_{};
+      size_t pending_{};
+      bool stop_{ false };
+#if defined(BENCHMARK_PARALLEL_STL_TBB)
+      tbb::global_control limit_;
+#endif
+   };
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // A work-stealing deque of chunk indices after Chase and Lev ("Dynamic Circular Work-Stealing
+   // Deque", SPAA 2005) with the memory orders of Le et al. ("Correct and Efficient Work-Stealing
+   // for Weak Memory Models", PPoPP 2013). The owning thread pushes and pops at the bottom without
+   // locking, other threads steal from the top; only the last element and steals need a CAS. The
+   // buffer does not grow, since all chunks are known before the threads start. top and bottom are
+   // kept on separate cache lines to avoid false sharing between the owner and the thieves.
+   class ChaseLevDeque
+   {
+    public:
+      explicit ChaseLevDeque( size_t capacity )
+         : mask_{ std::bit_ceil( std::max( capacity, size_t{1UL} ) ) - 1UL }
+         , buffer_( mask_ + 1UL )
+      {}
+
+      // Owner only; at most capacity elements.
+      void push( size_t item )
+      {
+         const int64_t b( bottom_.load( std::memory_order_relaxed ) );
+         buffer_[ static_cast<size_t>( b ) & mask_ ].store( item, std::memory_order_relaxed );
+         std::atomic_thread_fence( std::memory_order_release );
+         bottom_.store( b+1, std::memory_order_relaxed );
+      }
+
+      // Owner only. Returns false if the deque is empty.
+      bool pop( size_t& item )
+      {
+         const int64_t b( bottom_.load( std::memory_order_relaxed ) - 1 );
+         bottom_.store( b, std::memory_order_relaxed );
+         std::atomic_thread_fence( std::memory_order_seq_cst );
+         int64_t t( top_.load( std::memory_order_relaxed ) );
+
+         if( t > b ) {
+            bottom_.store( b+1, std::memory_order_relaxed );
+            return false;
+         }
+
+         item = buffer_[ static_cast<size_t>( b ) & mask_ ].load( std::memory_order_relaxed );
+
+         if( t < b )
+            return true;
+
+         // The last element: race against the thieves.
+         const bool won( top_.compare_exchange_strong( t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed ) );
+         bottom_.store( b+1, std::memory_order_relaxed );
+         return won;
+      }
+
+      // Any thread. Retries after a lost race, i.e. returns false only if the deque is empty.
+      bool steal( size_t& item )
+      {
+         for( ;; )
+         {
+            int64_t t( top_.load( std::memory_order_acquire ) );
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            const int64_t b( bottom_.load( std::memory_order_acquire ) );
+
+            if( t >= b )
+               return false;
+
+            item = buffer_[ static_cast<size_t>( t ) & mask_ ].load( std::memory_order_relaxed );
+
+            if( top_.compare_exchange_strong( t, t+1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+               return true;
+         }
+      }
+
+    private:
+      alignas(64) std::atomic<int64_t> top_{ 0 };
+      alignas(64) std::atomic<int64_t> bottom_{ 0 };
+      size_t mask_;
+      std::vector< std::atomic<size_t> > buffer_;
+   };
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // One Chase-Lev deque of chunk indices per thread. Every thread initially owns a contiguous
+   // block of the chunks, which it takes in ascending order, and steals from the other threads
+   // (starting with its right neighbour) once its own deque is empty. Since no chunks are added
+   // while the threads run, a thread that finds all deques empty is done.
+   class StealingQueues
+   {
+    public:
+      StealingQueues( size_t threads, size_t chunks )
+         : threads_{ threads }
+         , chunks_{ chunks }
+      {
+         for( size_t t=0UL; t<threads; ++t ) {
+            deques_.push_back( std::make_unique<ChaseLevDeque>( block( t+1UL ) - block( t ) ) );
+         }
+      }
+
+      // Hands out all chunks again. Called while the threads are idle; the pool's start of the
+      // next job publishes the deques.
+      void fill()
+      {
+         for( size_t t=0UL; t<deques_.size(); ++t ) {
+            for( size_t i=block( t+1UL ); i>block( t ); --i ) {
+               deques_[t]->push( i-1UL );
+            }
+         }
+      }
+
+      // Returns the index of the next chunk for thread t in chunk, or false if all are done.
+      bool next( size_t t, size_t& chunk )
+      {
+         if( deques_[t]->pop( chunk ) )
+            return true;
+
+         for( size_t i=1UL; i<deques_.size(); ++i ) {
+            if( deques_[(t+i) % deques_.size()]->steal( chunk ) )
+               return true;
+         }
+
+         return false;
+      }
+
+    private:
+      // The index of the first chunk of thread t.
+      size_t block( size_t t ) const { return chunks_ * t / threads_; }
+
+      size_t threads_;
+      size_t chunks_;
+      std::vector< std::unique_ptr<ChaseLevDeque> > deques_;
+   };
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Returns the chunks [0,size) is split into for the given schedule and pool.
+   inline std::vector<Chunk> make_chunks( Schedule schedule, const ThreadPool& pool, size_t size )
+   {
+      return make_chunks( size, schedule == Schedule::static_chunks ? pool.size()
+                                                                    : pool.size() * chunks_per_thread );
+   }
+
+   // Distributes chunks to the threads of a pool according to the schedule. run( body ) calls
+   // body( chunk ) for every chunk and returns once all chunks are done. The scheduler is set up
+   // once, outside of any timed region, and run() may be called repeatedly (e.g. once per step).
+   class ChunkScheduler
+   {
+    public:
+      ChunkScheduler( Schedule schedule, ThreadPool& pool, std::vector<Chunk> chunks )
+         : schedule_{ schedule }
+         , pool_{ pool }
+         , chunks_{ std::move(chunks) }
+         , queues_{ schedule == Schedule::stealing ? pool.size() : 0UL, chunks_.size() }
+      {}
+
+      const std::vector<Chunk>& chunks() const { return chunks_; }
+
+      template< typename Body >
+      void run( Body&& body )
+      {
+         switch( schedule_ )
+         {
+            case Schedule::static_chunks:
+               pool_.run( [&]( size_t t ){
+                  for( size_t i=t; i<chunks_.size(); i+=pool_.size() ) {
+                     body( chunks_[i] );
+                  }
+               } );
+               break;
+
+            case Schedule::stealing:
+               queues_.fill();
+               pool_.run( [&]( size_t t ){
+                  size_t i{};
+                  while( queues_.next( t, i ) ) {
+                     body( chunks_[i] );
+                  }
+               } );
+               break;
+
+            case Schedule::par_unseq:
+#if defined(BENCHMARK_PARALLEL_STL) && defined(__cpp_lib_execution)
+               std::for_each( std::execution::par_unseq, chunks_.begin(), chunks_.end()
+                            , [&]( const Chunk& chunk ){ body( chunk ); } );
+#else
+               std::for_each( chunks_.begin(), chunks_.end(), [&]( const Chunk& chunk ){ body( chunk ); } );
+#endif
+               break;
+         }
+      }
+
+    private:
+      Schedule schedule_;
+      ThreadPool& pool_;
+      std::vector<Chunk> chunks_;
+      StealingQueues queues_;
+   };
+   //**********************************************************************************************
+
+} // namespace parallel
+
+#endif
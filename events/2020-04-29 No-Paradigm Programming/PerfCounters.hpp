@@ -0,0 +1,200 @@
+/**************************************************************************************************
+*
+* \file PerfCounters.hpp
+* \brief C++ Training - Hardware performance counters for the design pattern benchmarks
+*
+* Copyright (C) 2015-2020 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#  include <asm/unistd.h>
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  include <cerrno>
+#  include <cstring>
+#endif
+
+
+namespace benchmark {
+
+   //**********************************************************************************************
+   // The names of all counters PerfCounters tries to open, in the order they are opened.
+   constexpr const char* counter_names[] = {
+      "cycles",
+      "instructions",
+      "branch-misses",
+      "L1-dcache-load-misses",
+      "iTLB-load-misses"
+   };
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // A set of hardware counters measured around a piece of code via perf_event_open. Every counter
+   // is opened on its own, such that a counter that is not supported by the CPU or the kernel is
+   // simply left out. If no counter can be opened at all (non-Linux platform, containers without
+   // CAP_PERFMON, perf_event_paranoid > 2, ...) the set is empty and all operations are no-ops.
+   class PerfCounters
+   {
+    public:
+      struct Counter
+      {
+         std::string name;
+         int fd;
+      };
+
+      PerfCounters()
+      {
+#if defined(__linux__)
+         add( "cycles",          PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES );
+         add( "instructions",    PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS );
+         add( "branch-misses",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES );
+         add( "L1-dcache-load-misses", PERF_TYPE_HW_CACHE
+            , PERF_COUNT_HW_CACHE_L1D | ( PERF_COUNT_HW_CACHE_OP_READ << 8 )
+                                      | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ) );
+         add( "iTLB-load-misses", PERF_TYPE_HW_CACHE
+            , PERF_COUNT_HW_CACHE_ITLB | ( PERF_COUNT_HW_CACHE_OP_READ << 8 )
+                                       | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 ) );
+#else
+         error_ = "perf_event_open is only available on Linux";
+#endif
+      }
+
+      PerfCounters( const PerfCounters& ) = delete;
+      PerfCounters& operator=( const PerfCounters& ) = delete;
+
+      ~PerfCounters()
+      {
+#if defined(__linux__)
+         for( const Counter& counter : counters_ ) {
+            close( counter.fd );
+         }
+#endif
+      }
+
+      bool available() const { return !counters_.empty(); }
+      const std::string& error() const { return error_; }
+      const std::vector<Counter>& counters() const { return counters_; }
+
+      // Resets and enables all counters. The reset does not affect the times enabled and running,
+      // which keep growing over all measurements, so they are recorded here for read().
+      void start()
+      {
+#if defined(__linux__)
+         for( size_t i=0UL; i<counters_.size(); ++i ) {
+            ioctl( counters_[i].fd, PERF_EVENT_IOC_RESET, 0 );
+            times_[i] = sample( counters_[i].fd ).value_or( Sample{} );
+         }
+         for( const Counter& counter : counters_ ) {
+            ioctl( counter.fd, PERF_EVENT_IOC_ENABLE, 0 );
+         }
+#endif
+      }
+
+      void stop()
+      {
+#if defined(__linux__)
+         for( const Counter& counter : counters_ ) {
+            ioctl( counter.fd, PERF_EVENT_IOC_DISABLE, 0 );
+         }
+#endif
+      }
+
+      // Returns the value of every counter since the last start(), in the order of counters().
+      // Values are scaled up if the kernel had to multiplex the counters. A counter that cannot be
+      // read or that was never scheduled during the measurement has no value.
+      std::vector< std::optional<double> > read() const
+      {
+         std::vector< std::optional<double> > values;
+         values.reserve( counters_.size() );
+
+#if defined(__linux__)
+         for( size_t i=0UL; i<counters_.size(); ++i )
+         {
+            const std::optional<Sample> current( sample( counters_[i].fd ) );
+
+            if( !current || current->running <= times_[i].running ) {
+               values.push_back( std::nullopt );
+               continue;
+            }
+
+            const uint64_t enabled( current->enabled - times_[i].enabled );
+            const uint64_t running( current->running - times_[i].running );
+
+            values.push_back( static_cast<double>( current->value )
+                            * static_cast<double>( enabled ) / static_cast<double>( running ) );
+         }
+#endif
+
+         return values;
+      }
+
+    private:
+      struct Sample
+      {
+         uint64_t value{};
+         uint64_t enabled{};  // Total time enabled
+         uint64_t running{};  // Total time running
+      };
+
+#if defined(__linux__)
+      static std::optional<Sample> sample( int fd )
+      {
+         uint64_t data[3] = {};  // value, time enabled, time running
+
+         if( ::read( fd, data, sizeof(data) ) != static_cast<ssize_t>( sizeof(data) ) )
+            return std::nullopt;
+
+         return Sample{ data[0], data[1], data[2] };
+      }
+
+      void add( const char* name, uint32_t type, uint64_t config )
+      {
+         perf_event_attr attr;
+         std::memset( &attr, 0, sizeof(attr) );
+         attr.size           = sizeof(attr);
+         attr.type           = type;
+         attr.config         = config;
+         attr.disabled       = 1;
+         attr.exclude_kernel = 1;
+         attr.exclude_hv     = 1;
+         attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+         const long fd( syscall( __NR_perf_event_open, &attr, 0, -1, -1, 0UL ) );
+
+         if( fd < 0L ) {
+            if( error_.empty() )
+               error_ = std::string( "perf_event_open failed for " ) + name + ": "
+                      + std::strerror( errno );
+            return;
+         }
+
+         counters_.push_back( Counter{ name, static_cast<int>( fd ) } );
+         times_.push_back( Sample{} );
+      }
+#endif
+
+      std::vector<Counter> counters_;
+      std::vector<Sample> times_;  // The times enabled and running at the last start()
+      std::string error_;
+   };
+   //**********************************************************************************************
+
+} // namespace benchmark
+
+#endif
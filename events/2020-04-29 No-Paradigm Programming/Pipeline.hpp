@@ -0,0 +1,209 @@
+/**************************************************************************************************
+*
+* \file Pipeline.hpp
+* \brief C++ Training - Coroutine pipeline for batching the steps of the design pattern benchmarks
+*
+* Copyright (C) 2015-2020 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <new>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace pipeline {
+
+   //**********************************************************************************************
+   // A lazily evaluated sequence of values produced by a coroutine via co_yield. The coroutine
+   // runs until its next co_yield whenever the iterator is incremented, i.e. producer and consumer
+   // alternate on the same thread without any buffering in between (see the 2020-05-18 Corobatch
+   // session for batching with coroutines). The coroutine frame is allocated with the alignment
+   // of a cache line, since the frame may hold over-aligned values (e.g. a yielded temporary of
+   // the CacheLine layout of Vector3D), but the default allocation of coroutine frames only
+   // guarantees the alignment of the default operator new.
+   template< typename T >
+   class Generator
+   {
+    public:
+      struct promise_type
+      {
+         static constexpr std::align_val_t frame_alignment{ alignof(T) > 64UL ? alignof(T) : 64UL };
+
+         const T* value{};
+         std::exception_ptr exception{};
+
+         static void* operator new( size_t size )
+         {
+            return ::operator new( size, frame_alignment );
+         }
+
+         static void operator delete( void* frame, size_t size )
+         {
+            ::operator delete( frame, size, frame_alignment );
+         }
+
+         Generator get_return_object()
+         {
+            return Generator{ std::coroutine_handle<promise_type>::from_promise( *this ) };
+         }
+
+         std::suspend_always initial_suspend() noexcept { return {}; }
+         std::suspend_always final_suspend() noexcept { return {}; }
+
+         // The value lives in the suspended coroutine frame until the coroutine is resumed.
+         std::suspend_always yield_value( const T& v ) noexcept
+         {
+            value = &v;
+            return {};
+         }
+
+         void return_void() noexcept {}
+         void unhandled_exception() { exception = std::current_exception(); }
+      };
+
+      class Iterator
+      {
+       public:
+         using value_type      = T;
+         using difference_type = std::ptrdiff_t;
+
+         Iterator() = default;
+
+         explicit Iterator( std::coroutine_handle<promise_type> coroutine )
+            : coroutine_{ coroutine }
+         {}
+
+         const T& operator*() const { return *coroutine_.promise().value; }
+
+         Iterator& operator++()
+         {
+            resume( coroutine_ );
+            return *this;
+         }
+
+         void operator++( int ) { ++*this; }
+
+         bool operator==( std::default_sentinel_t ) const { return coroutine_.done(); }
+
+       private:
+         std::coroutine_handle<promise_type> coroutine_{};
+      };
+
+      explicit Generator( std::coroutine_handle<promise_type> coroutine )
+         : coroutine_{ coroutine }
+      {}
+
+      Generator( Generator&& other ) noexcept
+         : coroutine_{ std::exchange( other.coroutine_, {} ) }
+      {}
+
+      Generator( const Generator& ) = delete;
+      Generator& operator=( const Generator& ) = delete;
+      Generator& operator=( Generator&& ) = delete;
+
+      ~Generator()
+      {
+         if( coroutine_ )
+            coroutine_.destroy();
+      }
+
+      Iterator begin()
+      {
+         resume( coroutine_ );
+         return Iterator{ coroutine_ };
+      }
+
+      std::default_sentinel_t end() const { return {}; }
+
+    private:
+      static void resume( std::coroutine_handle<promise_type> coroutine )
+      {
+         coroutine.resume();
+         if( coroutine.done() && coroutine.promise().exception )
+            std::rethrow_exception( coroutine.promise().exception );
+      }
+
+      std::coroutine_handle<promise_type> coroutine_;
+   };
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // The ways the consumer applies a batch of K translation vectors to the shapes:
+   //  - summed:    the K vectors are added up and the sum is applied in one call of translate(),
+   //               i.e. one pass over the shapes and one dispatch per shape for K steps. The
+   //               result differs from the per-step loop by the rounding of the additions.
+   //  - sequenced: the shapes are split into blocks of block_shapes shapes and all K vectors are
+   //               applied to a block before the next block is touched, i.e. one pass over the
+   //               memory of the shapes for K steps with the same result as the per-step loop.
+   enum class Combine
+   {
+      summed,
+      sequenced
+   };
+
+   inline std::string to_string( Combine combine )
+   {
+      switch( combine ) {
+         case Combine::summed:    return "summed";
+         case Combine::sequenced: return "sequenced";
+      }
+      return "";
+   }
+
+   // The number of shapes per block of the sequenced consumer, small enough for a block of shapes
+   // of every solution to stay in the L1 cache while the K vectors are applied.
+   constexpr size_t block_shapes = 256UL;
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // The batcher: accumulates the vectors of the producer into batches of K steps (the last batch
+   // may be shorter). A batch is valid until the consumer requests the next one.
+   template< typename Vector >
+   Generator< std::span<const Vector> > batches( Generator<Vector> steps, size_t K )
+   {
+      std::vector<Vector> batch;
+      batch.reserve( K );
+
+      for( const Vector& v : steps )
+      {
+         batch.push_back( v );
+
+         if( batch.size() == K ) {
+            co_yield std::span<const Vector>( batch );
+            batch.clear();
+         }
+      }
+
+      if( !batch.empty() )
+         co_yield std::span<const Vector>( batch );
+   }
+
+   template< typename Vector >
+   Vector sum( std::span<const Vector> batch )
+   {
+      Vector result{};
+      for( const Vector& v : batch ) {
+         result = result + v;
+      }
+      return result;
+   }
+   //**********************************************************************************************
+
+} // namespace pipeline
+
+#endif
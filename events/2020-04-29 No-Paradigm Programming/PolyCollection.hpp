@@ -0,0 +1,107 @@
+/**************************************************************************************************
+*
+* \file PolyCollection.hpp
+* \brief C++ Training - Type-partitioned polymorphic collection
+*
+* Copyright (C) 2015-2020 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef POLYCOLLECTION_HPP
+#define POLYCOLLECTION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace poly {
+
+   //**********************************************************************************************
+   // A collection of objects of the given types, which keeps one contiguous std::vector per type.
+   // The objects are visited segment by segment, i.e. there is no dispatch per element; the order
+   // of the elements across different types is not preserved.
+   template< typename... Types >
+   class Collection
+   {
+    public:
+      template< typename T >
+      void push_back( T&& t )
+      {
+         segment< std::decay_t<T> >().push_back( std::forward<T>( t ) );
+      }
+
+      template< typename T >
+      std::vector<T>& segment() { return std::get< std::vector<T> >( segments_ ); }
+
+      template< typename T >
+      const std::vector<T>& segment() const { return std::get< std::vector<T> >( segments_ ); }
+
+      template< typename Fn >
+      void for_each( Fn&& fn )
+      {
+         std::apply( [&]( auto&... segments ){ ( for_each_in( segments, fn ), ... ); }, segments_ );
+      }
+
+      // Calls fn for the elements [begin,end), counted over all segments in order, i.e. elements
+      // 0 to segment<T0>().size()-1 are the elements of the first segment, and so on.
+      template< typename Fn >
+      void for_each( Fn&& fn, size_t begin, size_t end )
+      {
+         for_each_segment( [&]( auto& segment, size_t first ){
+            for( size_t i=std::max( begin, first ); i<std::min( end, first+segment.size() ); ++i ) {
+               fn( segment[i-first] );
+            }
+         }, begin, end );
+      }
+
+      // Calls fn once per segment, i.e. with the std::vector of every type in turn.
+      template< typename Fn >
+      void for_each_segment( Fn&& fn )
+      {
+         std::apply( [&]( auto&... segments ){ ( fn( segments ), ... ); }, segments_ );
+      }
+
+      // Calls fn( segment, first ) for every segment that overlaps the elements [begin,end), with
+      // first the index of the segment's first element counted over all segments.
+      template< typename Fn >
+      void for_each_segment( Fn&& fn, size_t begin, size_t end )
+      {
+         size_t first( 0UL );
+
+         for_each_segment( [&]( auto& segment ){
+            if( first < end && begin < first+segment.size() )
+               fn( segment, first );
+            first += segment.size();
+         } );
+      }
+
+      size_t size() const
+      {
+         return std::apply( []( const auto&... segments ){ return ( segments.size() + ... + 0UL ); }, segments_ );
+      }
+
+      bool empty() const { return size() == 0UL; }
+
+    private:
+      template< typename T, typename Fn >
+      static void for_each_in( std::vector<T>& segment, Fn& fn )
+      {
+         for( T& t : segment ) {
+            fn( t );
+         }
+      }
+
+      std::tuple< std::vector<Types>... > segments_;
+   };
+   //**********************************************************************************************
+
+} // namespace poly
+
+#endif
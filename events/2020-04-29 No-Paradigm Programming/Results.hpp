@@ -0,0 +1,705 @@
+/**************************************************************************************************
+*
+* \file Results.hpp
+* \brief C++ Training - Results and result output of the design pattern benchmarks
+*
+* Copyright (C) 2015-2020 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef RESULTS_HPP
+#define RESULTS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <istream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "PerfCounters.hpp"
+
+
+namespace benchmark {
+
+   //**********************************************************************************************
+   // Summary statistics of a set of timing samples (in seconds). The confidence interval is the
+   // distribution-free interval of the median given by the order statistics of the samples.
+   struct Statistics
+   {
+      size_t samples{};
+      double median{};
+      double mad{};
+      double min{};
+      double max{};
+      double mean{};
+      double p90{};
+      double ci_lower{};
+      double ci_upper{};
+   };
+
+   inline double percentile( const std::vector<double>& sorted, double p )
+   {
+      if( sorted.empty() )
+         return 0.0;
+
+      const double pos( p * static_cast<double>( sorted.size() - 1UL ) );
+      const size_t lower( static_cast<size_t>( std::floor( pos ) ) );
+      const size_t upper( std::min( lower + 1UL, sorted.size() - 1UL ) );
+      const double frac( pos - static_cast<double>( lower ) );
+
+      return sorted[lower] + frac * ( sorted[upper] - sorted[lower] );
+   }
+
+   // The 0-based ranks of the sorted samples that bound the confidence interval of the median, i.e.
+   // j = ceil( n/2 - z*sqrt(n)/2 ) - 1 and k = floor( n/2 + z*sqrt(n)/2 ), clamped to [0,n-1].
+   // For small n the interval cannot reach the requested coverage and degrades to [min,max].
+   struct MedianRanks
+   {
+      size_t lower;
+      size_t upper;
+   };
+
+   constexpr MedianRanks median_ci_ranks( size_t n, double z = 1.96 )
+   {
+      if( n == 0UL )
+         return MedianRanks{ 0UL, 0UL };
+
+      // Newton iteration, since std::sqrt() is not usable in constant expressions.
+      double root( static_cast<double>( n ) );
+      for( int i=0; i<64; ++i ) {
+         root = 0.5 * ( root + static_cast<double>( n ) / root );
+      }
+
+      const double center( 0.5 * static_cast<double>( n ) );
+      const double half( 0.5 * z * root );
+
+      const double lower( center - half );
+      const double upper( center + half );
+
+      long j( static_cast<long>( lower ) );
+      if( static_cast<double>( j ) < lower ) ++j;  // ceil
+      --j;
+
+      long k( static_cast<long>( upper ) );
+      if( static_cast<double>( k ) > upper ) --k;  // floor
+
+      const long last( static_cast<long>( n-1UL ) );
+
+      return MedianRanks{ static_cast<size_t>( std::clamp( j, 0L, last ) )
+                        , static_cast<size_t>( std::clamp( k, 0L, last ) ) };
+   }
+
+   // The ranks of the exact binomial interval: [x(2),x(9)] for n=10 and [x(6),x(15)] for n=20 in
+   // 1-based order statistics.
+   static_assert( median_ci_ranks( 10UL ).lower == 1UL && median_ci_ranks( 10UL ).upper == 8UL );
+   static_assert( median_ci_ranks( 20UL ).lower == 5UL && median_ci_ranks( 20UL ).upper == 14UL );
+
+   inline Statistics compute_statistics( std::vector<double> samples, double z = 1.96 )
+   {
+      Statistics stats{};
+      stats.samples = samples.size();
+
+      if( samples.empty() )
+         return stats;
+
+      std::sort( samples.begin(), samples.end() );
+
+      const size_t n( samples.size() );
+
+      stats.min    = samples.front();
+      stats.max    = samples.back();
+      stats.median = percentile( samples, 0.5 );
+      stats.p90    = percentile( samples, 0.9 );
+
+      double sum{};
+      for( double s : samples ) {
+         sum += s;
+      }
+      stats.mean = sum / static_cast<double>( n );
+
+      std::vector<double> deviations;
+      deviations.reserve( n );
+      for( double s : samples ) {
+         deviations.push_back( std::abs( s - stats.median ) );
+      }
+      std::sort( deviations.begin(), deviations.end() );
+      stats.mad = percentile( deviations, 0.5 );
+
+      const MedianRanks ranks( median_ci_ranks( n, z ) );
+      stats.ci_lower = samples[ranks.lower];
+      stats.ci_upper = samples[ranks.upper];
+
+      return stats;
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // The value of a counter in every timed repetition. A repetition in which the counter could not
+   // be read, or was never scheduled, has no value.
+   struct CounterSamples
+   {
+      std::string name;
+      std::vector< std::optional<double> > values;
+   };
+
+   struct Result
+   {
+      std::string name;
+      std::string label;
+      std::vector<double> samples;
+      Statistics stats;
+      std::vector<CounterSamples> counters;
+      size_t shapes{};
+      size_t steps{};
+      size_t types{ 2UL };
+      size_t heap_bytes{};    // Heap footprint of the shapes (0 if not measured)
+      size_t code_bytes{};    // Machine code size of the solution (0 if not measured)
+      size_t threads{};       // Number of threads (0 for the sequential loop)
+      std::string schedule{}; // Distribution of the shapes to the threads (empty if sequential)
+      size_t batch{};         // Steps per pass of the batched pipeline (0 for the per-step loop)
+      std::string combine{};  // Consumer of the batched pipeline (empty for the per-step loop)
+      size_t read_interval{}; // Steps between two reads of deferred translations (0 if immediate)
+      std::string deferral{}; // Recording of the deferred translations (empty if immediate; "per-shape"
+                              // with read_interval 0 for the immediate loop over the same subsets)
+
+      double updates() const
+      {
+         return static_cast<double>( shapes ) * static_cast<double>( steps );
+      }
+
+      double ns_per_shape() const
+      {
+         return updates() > 0.0 ? 1E9 * stats.median / updates() : 0.0;
+      }
+
+      // Returns the median of the given counter per shape update over the repetitions in which it
+      // was measured, or a negative value if the counter was not measured at all.
+      double counter_per_shape( const std::string& counter ) const
+      {
+         for( const CounterSamples& c : counters )
+         {
+            if( c.name != counter || updates() <= 0.0 )
+               continue;
+
+            std::vector<double> values;
+            for( const std::optional<double>& value : c.values ) {
+               if( value )
+                  values.push_back( *value );
+            }
+
+            if( !values.empty() )
+               return compute_statistics( values ).median / updates();
+         }
+         return -1.0;
+      }
+   };
+   //**********************************************************************************************
+
+
+
+   //**********************************************************************************************
+   // Description of the environment a set of results was measured in. It is attached to every
+   // record of the structured output, such that records from different runs can be merged.
+   struct Metadata
+   {
+      std::string binary;
+      std::string compiler;
+      std::string flags;
+      std::string cpu;
+      std::string timestamp;
+      unsigned int seed{};
+      std::string translations;
+      std::string order;
+      std::string alloc;
+      std::string layout;
+      size_t imbalance{};
+      size_t warmup{};
+   };
+
+   inline std::string compiler_version()
+   {
+#if defined(__clang__)
+      return std::string( "clang " ) + __clang_version__;
+#elif defined(__GNUC__)
+      return std::string( "gcc " ) + __VERSION__;
+#elif defined(_MSC_VER)
+      return "msvc " + std::to_string( _MSC_FULL_VER );
+#else
+      return "unknown";
+#endif
+   }
+
+   // The compiler flags cannot be queried portably. They can be passed in when building, e.g.
+   // -DBENCHMARK_COMPILE_FLAGS="\"-O3 -march=native\"". Otherwise the flags are reconstructed as
+   // far as the predefined macros allow.
+   inline std::string compile_flags()
+   {
+#if defined(BENCHMARK_COMPILE_FLAGS)
+      return BENCHMARK_COMPILE_FLAGS;
+#else
+      std::string flags;
+#  if defined(__OPTIMIZE__)
+      flags += " __OPTIMIZE__";
+#  endif
+#  if defined(NDEBUG)
+      flags += " NDEBUG";
+#  endif
+#  if defined(__AVX512F__)
+      flags += " AVX512F";
+#  elif defined(__AVX2__)
+      flags += " AVX2";
+#  elif defined(__SSE4_2__)
+      flags += " SSE4.2";
+#  endif
+      return flags.empty() ? "unknown" : flags.substr( 1UL );
+#endif
+   }
+
+   inline std::string cpu_model()
+   {
+      std::ifstream cpuinfo( "/proc/cpuinfo" );
+      std::string line;
+
+      while( std::getline( cpuinfo, line ) )
+      {
+         if( line.compare( 0UL, 10UL, "model name" ) == 0 )
+         {
+            const std::string::size_type colon( line.find( ':' ) );
+            if( colon != std::string::npos )
+               return line.substr( line.find_first_not_of( " \t", colon+1UL ) );
+         }
+      }
+
+      return "unknown";
+   }
+
+   inline std::string utc_timestamp()
+   {
+      const std::time_t now( std::time( nullptr ) );
+      char buffer[32] = {};
+      std::strftime( buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", std::gmtime( &now ) );
+      return buffer;
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   inline std::string csv_escape( const std::string& value )
+   {
+      if( value.find_first_of( ",\"\n" ) == std::string::npos )
+         return value;
+
+      std::string escaped( "\"" );
+      for( char c : value ) {
+         if( c == '"' )
+            escaped += '"';
+         escaped += c;
+      }
+      return escaped + "\"";
+   }
+
+   inline std::string json_escape( const std::string& value )
+   {
+      std::string escaped( "\"" );
+      for( char c : value )
+      {
+         switch( c ) {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:   escaped += c; break;
+         }
+      }
+      return escaped + "\"";
+   }
+
+   // Writes one record per (solution, N, steps, repetition). The counter columns and the code_bytes
+   // column are always present and left empty if they were not measured.
+   inline void write_csv( std::ostream& os, const Metadata& meta, const std::vector<Result>& results )
+   {
+      os << "binary,solution,types,shapes,steps,repetition,seconds,ns_per_shape,heap_bytes,code_bytes,threads,schedule,batch,combine,read_interval,deferral,seed,translations,order,alloc,layout,imbalance,warmup"
+         << ",compiler,flags,cpu,timestamp";
+      for( const char* counter : counter_names ) {
+         os << "," << counter;
+      }
+      os << "\n";
+
+      os << std::setprecision( 10 );
+
+      for( const Result& result : results )
+      {
+         for( size_t rep=0UL; rep<result.samples.size(); ++rep )
+         {
+            os << csv_escape( meta.binary ) << "," << csv_escape( result.name )
+               << "," << result.types << "," << result.shapes << "," << result.steps << "," << rep
+               << "," << result.samples[rep]
+               << "," << ( result.updates() > 0.0 ? 1E9 * result.samples[rep] / result.updates() : 0.0 )
+               << "," << result.heap_bytes << "," << ( result.code_bytes > 0UL ? std::to_string( result.code_bytes ) : "" )
+               << "," << result.threads << "," << result.schedule
+               << "," << result.batch << "," << result.combine
+               << "," << result.read_interval << "," << result.deferral
+               << "," << meta.seed << "," << meta.translations << "," << meta.order << "," << csv_escape( meta.alloc ) << "," << meta.layout << "," << meta.imbalance << "," << meta.warmup
+               << "," << csv_escape( meta.compiler ) << "," << csv_escape( meta.flags )
+               << "," << csv_escape( meta.cpu ) << "," << meta.timestamp;
+
+            for( const char* counter : counter_names )
+            {
+               os << ",";
+               for( const CounterSamples& c : result.counters ) {
+                  if( c.name == counter && rep < c.values.size() && c.values[rep] )
+                     os << *c.values[rep];
+               }
+            }
+
+            os << "\n";
+         }
+      }
+   }
+
+   inline void write_json( std::ostream& os, const Metadata& meta, const std::vector<Result>& results )
+   {
+      os << std::setprecision( 10 ) << "[";
+
+      bool first( true );
+
+      for( const Result& result : results )
+      {
+         for( size_t rep=0UL; rep<result.samples.size(); ++rep )
+         {
+            os << ( first ? "\n" : ",\n" ) << "  {"
+               << " \"binary\": " << json_escape( meta.binary )
+               << ", \"solution\": " << json_escape( result.name )
+               << ", \"types\": " << result.types
+               << ", \"shapes\": " << result.shapes
+               << ", \"steps\": " << result.steps
+               << ", \"repetition\": " << rep
+               << ", \"seconds\": " << result.samples[rep]
+               << ", \"ns_per_shape\": " << ( result.updates() > 0.0 ? 1E9 * result.samples[rep] / result.updates() : 0.0 )
+               << ", \"heap_bytes\": " << result.heap_bytes
+               << ", \"code_bytes\": " << ( result.code_bytes > 0UL ? std::to_string( result.code_bytes ) : "null" )
+               << ", \"threads\": " << result.threads
+               << ", \"schedule\": " << json_escape( result.schedule )
+               << ", \"batch\": " << result.batch
+               << ", \"combine\": " << json_escape( result.combine )
+               << ", \"read_interval\": " << result.read_interval
+               << ", \"deferral\": " << json_escape( result.deferral )
+               << ", \"seed\": " << meta.seed
+               << ", \"translations\": " << json_escape( meta.translations )
+               << ", \"order\": " << json_escape( meta.order )
+               << ", \"alloc\": " << json_escape( meta.alloc )
+               << ", \"layout\": " << json_escape( meta.layout )
+               << ", \"imbalance\": " << meta.imbalance
+               << ", \"warmup\": " << meta.warmup
+               << ", \"compiler\": " << json_escape( meta.compiler )
+               << ", \"flags\": " << json_escape( meta.flags )
+               << ", \"cpu\": " << json_escape( meta.cpu )
+               << ", \"timestamp\": " << json_escape( meta.timestamp )
+               << ", \"counters\": {";
+
+            bool firstCounter( true );
+            for( const CounterSamples& c : result.counters ) {
+               if( rep < c.values.size() && c.values[rep] ) {
+                  os << ( firstCounter ? " " : ", " ) << json_escape( c.name ) << ": " << *c.values[rep];
+                  firstCounter = false;
+               }
+            }
+
+            os << ( firstCounter ? "}" : " }" ) << " }";
+            first = false;
+         }
+      }
+
+      os << "\n]\n";
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Two-sided p-value of the Mann-Whitney U test (normal approximation with tie correction) for
+   // the hypothesis that the samples a and b stem from the same distribution.
+   inline double mann_whitney_p( const std::vector<double>& a, const std::vector<double>& b )
+   {
+      const size_t n1( a.size() );
+      const size_t n2( b.size() );
+
+      if( n1 == 0UL || n2 == 0UL )
+         return 1.0;
+
+      std::vector< std::pair<double,size_t> > all;
+      all.reserve( n1 + n2 );
+      for( double x : a ) all.emplace_back( x, 0UL );
+      for( double x : b ) all.emplace_back( x, 1UL );
+      std::sort( all.begin(), all.end() );
+
+      const double n( static_cast<double>( n1 + n2 ) );
+      double rankSum{};
+      double tieCorrection{};
+
+      for( size_t i=0UL; i<all.size(); )
+      {
+         size_t j( i );
+         while( j < all.size() && all[j].first == all[i].first ) {
+            ++j;
+         }
+
+         const double rank( 0.5 * static_cast<double>( i + j + 1UL ) );
+         const double ties( static_cast<double>( j - i ) );
+         tieCorrection += ties*ties*ties - ties;
+
+         for( size_t k=i; k<j; ++k ) {
+            if( all[k].second == 0UL )
+               rankSum += rank;
+         }
+
+         i = j;
+      }
+
+      const double m1( static_cast<double>( n1 ) );
+      const double m2( static_cast<double>( n2 ) );
+      const double u( rankSum - 0.5 * m1 * ( m1 + 1.0 ) );
+      const double mean( 0.5 * m1 * m2 );
+      const double variance( m1 * m2 / 12.0 * ( ( n + 1.0 ) - tieCorrection / ( n * ( n - 1.0 ) ) ) );
+
+      if( variance <= 0.0 )
+         return 1.0;
+
+      const double z( ( std::abs( u - mean ) - 0.5 ) / std::sqrt( variance ) );
+
+      return std::min( 1.0, std::erfc( std::max( z, 0.0 ) / std::sqrt( 2.0 ) ) );
+   }
+
+   // Smallest p-value mann_whitney_p() can return for samples of sizes n1 and n2, which is reached
+   // if all samples of one set are smaller than all samples of the other. If it is not below the
+   // significance level, no difference can be significant.
+   inline double mann_whitney_min_p( size_t n1, size_t n2 )
+   {
+      std::vector<double> a( n1 );
+      std::vector<double> b( n2 );
+
+      for( size_t i=0UL; i<n1; ++i ) a[i] = static_cast<double>( i );
+      for( size_t i=0UL; i<n2; ++i ) b[i] = static_cast<double>( n1 + i );
+
+      return mann_whitney_p( a, b );
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Baseline samples (ns per shape update) read from a CSV file written by write_csv(), keyed by
+   // the values of all configuration columns, i.e. of all columns except the measured values and
+   // the description of the build and machine (measurement_columns and the counters). Records are
+   // thus only compared with records of the same binary, solution, number of shapes and settings of
+   // the run. The number of steps is not part of the key, since the ns per shape update are
+   // comparable across step counts.
+   using BaselineKey = std::map<std::string,std::string>;
+   using Baseline    = std::map< BaselineKey, std::vector<double> >;
+
+   constexpr const char* measurement_columns[] = {
+      "steps", "repetition", "seconds", "ns_per_shape", "heap_bytes", "code_bytes", "seed", "warmup", "compiler", "flags", "cpu", "timestamp"
+   };
+
+   inline bool is_configuration_column( const std::string& column )
+   {
+      auto matches = [&]( const char* name ){ return column == name; };
+
+      return std::none_of( std::begin( measurement_columns ), std::end( measurement_columns ), matches ) &&
+             std::none_of( std::begin( counter_names ), std::end( counter_names ), matches );
+   }
+
+   inline std::vector<std::string> parse_csv_line( const std::string& line )
+   {
+      std::vector<std::string> fields( 1UL );
+      bool quoted( false );
+
+      for( size_t i=0UL; i<line.size(); ++i )
+      {
+         const char c( line[i] );
+
+         if( quoted ) {
+            if( c == '"' && i+1UL < line.size() && line[i+1UL] == '"' ) {
+               fields.back() += '"';
+               ++i;
+            }
+            else if( c == '"' ) {
+               quoted = false;
+            }
+            else {
+               fields.back() += c;
+            }
+         }
+         else if( c == '"' ) {
+            quoted = true;
+         }
+         else if( c == ',' ) {
+            fields.emplace_back();
+         }
+         else if( c != '\r' ) {
+            fields.back() += c;
+         }
+      }
+
+      return fields;
+   }
+
+   inline Baseline read_baseline( std::istream& is )
+   {
+      std::string line;
+
+      if( !std::getline( is, line ) )
+         throw std::runtime_error( "Empty baseline file" );
+
+      const std::vector<std::string> header( parse_csv_line( line ) );
+
+      auto column = [&]( const char* name ) {
+         const auto pos( std::find( header.begin(), header.end(), name ) );
+         if( pos == header.end() )
+            throw std::runtime_error( std::string( "Baseline file lacks column " ) + name );
+         return static_cast<size_t>( pos - header.begin() );
+      };
+
+      // The columns every record of write_csv() has, whatever the configuration.
+      column( "binary" );
+      column( "solution" );
+      column( "shapes" );
+      const size_t ns( column( "ns_per_shape" ) );
+
+      Baseline baseline;
+
+      while( std::getline( is, line ) )
+      {
+         if( line.empty() || line == "\r" )
+            continue;
+
+         const std::vector<std::string> fields( parse_csv_line( line ) );
+
+         if( fields.size() != header.size() )
+            throw std::runtime_error( "Malformed baseline record: " + line );
+
+         BaselineKey key;
+         for( size_t i=0UL; i<header.size(); ++i ) {
+            if( is_configuration_column( header[i] ) )
+               key.emplace( header[i], fields[i] );
+         }
+
+         try {
+            baseline[key].push_back( std::stod( fields[ns] ) );
+         }
+         catch( const std::logic_error& ) {
+            throw std::runtime_error( "Malformed baseline record: " + line );
+         }
+      }
+
+      return baseline;
+   }
+
+   struct Comparison
+   {
+      std::string solution;
+      size_t shapes{};
+      double baseline{};  // median ns per shape update of the baseline
+      double current{};   // median ns per shape update of this run
+      double change{};    // relative change of the median, positive means slower
+      double p_value{};
+      double min_p{};     // smallest p-value the numbers of samples can reach
+      size_t baseline_samples{};
+      size_t current_samples{};
+      bool regression{};
+      bool missing{};     // no baseline record of the same configuration
+   };
+
+   // Compares the results with the baseline. A solution has regressed if its median is slower by
+   // more than the given relative threshold and the difference is significant at level alpha. A
+   // result without a baseline record of the same configuration yields a comparison marked as
+   // missing. The results are keyed exactly like the baseline by reading back their CSV records.
+   inline std::vector<Comparison> compare( const Metadata& meta, const std::vector<Result>& results
+                                         , const Baseline& baseline, double threshold, double alpha )
+   {
+      std::vector<Comparison> comparisons;
+
+      for( const Result& result : results )
+      {
+         if( result.updates() <= 0.0 || result.samples.empty() )
+            continue;
+
+         std::stringstream records;
+         write_csv( records, meta, { result } );
+         const Baseline own( read_baseline( records ) );
+         const auto& [key,current] = *own.begin();
+
+         const auto pos( baseline.find( key ) );
+
+         Comparison c{};
+         c.solution = result.types == 2UL ? result.name : result.name + " K=" + std::to_string( result.types );
+         c.shapes   = result.shapes;
+
+         if( pos == baseline.end() ) {
+            c.missing = true;
+            comparisons.push_back( c );
+            continue;
+         }
+
+         c.baseline   = compute_statistics( pos->second ).median;
+         c.current    = compute_statistics( current ).median;
+         c.change     = c.baseline > 0.0 ? c.current / c.baseline - 1.0 : 0.0;
+         c.p_value    = mann_whitney_p( current, pos->second );
+         c.min_p      = mann_whitney_min_p( current.size(), pos->second.size() );
+         c.baseline_samples = pos->second.size();
+         c.current_samples  = current.size();
+         c.regression = c.change > threshold && c.p_value < alpha;
+
+         comparisons.push_back( c );
+      }
+
+      return comparisons;
+   }
+
+   inline void print( std::ostream& os, const std::vector<Comparison>& comparisons )
+   {
+      const auto flags( os.flags() );
+      const auto precision( os.precision() );
+
+      os << " Comparison with baseline (median ns per shape update)\n\n"
+         << std::left << std::setw( 32 ) << " solution" << std::right << std::setw( 12 ) << "N"
+         << std::setw( 12 ) << "baseline" << std::setw( 12 ) << "current"
+         << std::setw( 11 ) << "change" << std::setw( 10 ) << "p" << "\n";
+
+      for( const Comparison& c : comparisons )
+      {
+         os << " " << std::left << std::setw( 31 ) << c.solution << std::right << std::setw( 12 ) << c.shapes;
+
+         if( c.missing ) {
+            os << std::setw( 12 ) << "-" << "  MISSING\n";
+            continue;
+         }
+
+         os << std::fixed << std::setprecision( 3 )
+            << std::setw( 12 ) << c.baseline << std::setw( 12 ) << c.current
+            << std::setw( 10 ) << std::showpos << 100.0 * c.change << "%" << std::noshowpos
+            << std::setw( 10 ) << c.p_value
+            << ( c.regression ? "  REGRESSION" : "" ) << "\n";
+      }
+
+      os << "\n";
+
+      os.flags( flags );
+      os.precision( precision );
+   }
+   //**********************************************************************************************
+
+} // namespace benchmark
+
+#endif
@@ -0,0 +1,178 @@
+/**************************************************************************************************
+*
+* \file ShapeStore.hpp
+* \brief C++ Training - Structure-of-arrays shape storage with a vectorized translate kernel
+*
+* Copyright (C) 2015-2020 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef SHAPESTORE_HPP
+#define SHAPESTORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__AVX__)
+#  include <immintrin.h>
+#endif
+
+
+namespace soa {
+
+   //**********************************************************************************************
+   template< typename T, size_t Alignment >
+   struct AlignedAllocator
+   {
+      using value_type = T;
+
+      template< typename U >
+      struct rebind { using other = AlignedAllocator<U,Alignment>; };
+
+      AlignedAllocator() = default;
+
+      template< typename U >
+      AlignedAllocator( const AlignedAllocator<U,Alignment>& ) {}
+
+      T* allocate( size_t n )
+      {
+         return static_cast<T*>( ::operator new( n*sizeof(T), std::align_val_t{ Alignment } ) );
+      }
+
+      void deallocate( T* p, size_t )
+      {
+         ::operator delete( p, std::align_val_t{ Alignment } );
+      }
+
+      template< typename U >
+      bool operator==( const AlignedAllocator<U,Alignment>& ) const { return true; }
+
+      template< typename U >
+      bool operator!=( const AlignedAllocator<U,Alignment>& ) const { return false; }
+   };
+
+   constexpr size_t alignment = 64UL;
+
+   template< typename T >
+   using AlignedVector = std::vector< T, AlignedAllocator<T,alignment> >;
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Adds d to all n elements of the array data. The kernel is selected at compile time: AVX-512
+   // or AVX(2) if the translation unit is compiled for it (e.g. -march=native), a scalar loop
+   // (which the compiler is free to vectorize with SSE2) otherwise. The vector kernels use aligned
+   // loads and stores; the elements in front of the first 64-byte boundary are added one by one.
+   inline const char* kernel_name()
+   {
+#if defined(__AVX512F__)
+      return "AVX-512";
+#elif defined(__AVX2__)
+      return "AVX2";
+#elif defined(__AVX__)
+      return "AVX";
+#else
+      return "scalar";
+#endif
+   }
+
+   inline void add( double* data, size_t n, double d )
+   {
+      size_t i( 0UL );
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__AVX__)
+      for( ; i<n && reinterpret_cast<uintptr_t>( data+i ) % alignment != 0UL; ++i ) {
+         data[i] += d;
+      }
+#endif
+
+#if defined(__AVX512F__)
+      const __m512d vd( _mm512_set1_pd( d ) );
+      for( ; i+8UL<=n; i+=8UL ) {
+         _mm512_store_pd( data+i, _mm512_add_pd( _mm512_load_pd( data+i ), vd ) );
+      }
+#elif defined(__AVX2__) || defined(__AVX__)
+      const __m256d vd( _mm256_set1_pd( d ) );
+      for( ; i+8UL<=n; i+=8UL ) {
+         _mm256_store_pd( data+i,      _mm256_add_pd( _mm256_load_pd( data+i ),      vd ) );
+         _mm256_store_pd( data+i+4UL,  _mm256_add_pd( _mm256_load_pd( data+i+4UL ),  vd ) );
+      }
+#endif
+
+      for( ; i<n; ++i ) {
+         data[i] += d;
+      }
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Shapes stored as a structure of arrays: the coordinates of the centers, the extent (radius
+   // or side) and the type of shape i are x[i], y[i], z[i], extent[i] and type[i].
+   class ShapeStore
+   {
+    public:
+      void push_back( uint8_t t, double e )
+      {
+         x.push_back( 0.0 );
+         y.push_back( 0.0 );
+         z.push_back( 0.0 );
+         extent.push_back( e );
+         type.push_back( t );
+      }
+
+      void reserve( size_t n )
+      {
+         x.reserve( n );
+         y.reserve( n );
+         z.reserve( n );
+         extent.reserve( n );
+         type.reserve( n );
+      }
+
+      size_t size() const { return x.size(); }
+      bool empty() const { return x.empty(); }
+
+      void translate( double dx, double dy, double dz )
+      {
+         add( x.data(), x.size(), dx );
+         add( y.data(), y.size(), dy );
+         add( z.data(), z.size(), dz );
+      }
+
+      // Translates the shapes [begin,end) only.
+      void translate( double dx, double dy, double dz, size_t begin, size_t end )
+      {
+         add( x.data()+begin, end-begin, dx );
+         add( y.data()+begin, end-begin, dy );
+         add( z.data()+begin, end-begin, dz );
+      }
+
+      AlignedVector<double> x;
+      AlignedVector<double> y;
+      AlignedVector<double> z;
+      AlignedVector<double> extent;
+      std::vector<uint8_t> type;
+   };
+
+   template< typename Vector >
+   void translate( ShapeStore& shapes, const Vector& v )
+   {
+      shapes.translate( v.x, v.y, v.z );
+   }
+
+   template< typename Vector >
+   void translate( ShapeStore& shapes, const Vector& v, size_t begin, size_t end )
+   {
+      shapes.translate( v.x, v.y, v.z, begin, end );
+   }
+   //**********************************************************************************************
+
+} // namespace soa
+
+#endif
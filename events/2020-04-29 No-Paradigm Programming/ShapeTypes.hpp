@@ -0,0 +1,104 @@
+/**************************************************************************************************
+*
+* \file ShapeTypes.hpp
+* \brief C++ Training - Compile time generation of K shape types for the dispatch benchmarks
+*
+* Copyright (C) 2015-2020 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef SHAPETYPES_HPP
+#define SHAPETYPES_HPP
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+
+namespace shape_types {
+
+   //**********************************************************************************************
+   // The numbers of shape types every generated solution is instantiated for.
+   using Counts = std::index_sequence<2,4,8,16,32,64>;
+
+   constexpr size_t max_count = 64UL;
+
+   template< size_t... Ks >
+   constexpr bool contains( size_t K, std::index_sequence<Ks...> )
+   {
+      return ( ( K == Ks ) || ... );
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Calls f( std::integral_constant<size_t,I>{} ) for the given runtime type index I < K via a
+   // single switch statement, i.e. the same jump table a hand-written switch over K enumerators
+   // compiles to. Indices >= K are ignored.
+#define SHAPE_TYPES_CASE(I) \
+   case I: if constexpr( I < K ) { f( std::integral_constant<size_t,I>{} ); } break;
+
+#define SHAPE_TYPES_CASES_8(I) \
+   SHAPE_TYPES_CASE(I+0) SHAPE_TYPES_CASE(I+1) SHAPE_TYPES_CASE(I+2) SHAPE_TYPES_CASE(I+3) \
+   SHAPE_TYPES_CASE(I+4) SHAPE_TYPES_CASE(I+5) SHAPE_TYPES_CASE(I+6) SHAPE_TYPES_CASE(I+7)
+
+   template< size_t K, typename F >
+   inline void dispatch( size_t type, F&& f )
+   {
+      static_assert( K <= max_count, "Too many shape types" );
+
+      switch( type )
+      {
+         SHAPE_TYPES_CASES_8(0)  SHAPE_TYPES_CASES_8(8)  SHAPE_TYPES_CASES_8(16) SHAPE_TYPES_CASES_8(24)
+         SHAPE_TYPES_CASES_8(32) SHAPE_TYPES_CASES_8(40) SHAPE_TYPES_CASES_8(48) SHAPE_TYPES_CASES_8(56)
+         default: break;
+      }
+   }
+
+#undef SHAPE_TYPES_CASES_8
+#undef SHAPE_TYPES_CASE
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Builds the class hierarchy Slot<K-1,Slot<K-2,...Slot<0,Root>...>>. With a Slot that declares
+   // (or overrides) one virtual function for the shape type I, this yields an interface with K
+   // overloads in a single vtable, e.g. a Visitor with K visit() functions.
+   template< size_t K, template< size_t, typename > class Slot, typename Root >
+   struct Chain
+   {
+      using type = Slot< K-1UL, typename Chain< K-1UL, Slot, Root >::type >;
+   };
+
+   template< template< size_t, typename > class Slot, typename Root >
+   struct Chain< 0UL, Slot, Root >
+   {
+      using type = Root;
+   };
+
+   template< size_t K, template< size_t, typename > class Slot, typename Root >
+   using Chain_t = typename Chain<K,Slot,Root>::type;
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Variant< T<0>, T<1>, ..., T<K-1> >
+   template< template< typename... > class Variant, template< size_t > class T, typename Indices >
+   struct VariantOf;
+
+   template< template< typename... > class Variant, template< size_t > class T, size_t... Is >
+   struct VariantOf< Variant, T, std::index_sequence<Is...> >
+   {
+      using type = Variant< T<Is>... >;
+   };
+
+   template< size_t K, template< typename... > class Variant, template< size_t > class T >
+   using VariantOf_t = typename VariantOf< Variant, T, std::make_index_sequence<K> >::type;
+   //**********************************************************************************************
+
+} // namespace shape_types
+
+#endif
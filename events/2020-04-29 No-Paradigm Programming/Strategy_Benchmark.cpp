@@ -10,26 +10,24 @@
 *
 **************************************************************************************************/
 
-#include <chrono>
+#include <algorithm>
+#include <cstddef>
 #include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <memory>
-#include <random>
+#include <new>
+#include <span>
+#include <typeindex>
+#include <type_traits>
+#include <utility>
 #include <vector>
-
-
-struct Vector3D
-{
-   double x{};
-   double y{};
-   double z{};
-};
-
-Vector3D operator+( const Vector3D& a, const Vector3D& b )
-{
-   return Vector3D{ a.x+b.x, a.y+b.y, a.z+b.z };
-}
+#include "Benchmark.hpp"
+#include "PolyCollection.hpp"
+#include "ShapeStore.hpp"
+#include "ShapeTypes.hpp"
+#include "Vector3D.hpp"
 
 
 namespace classic_solution {
@@ -107,7 +105,7 @@ namespace classic_solution {
 
    using Shapes = std::vector< std::unique_ptr<Shape> >;
 
-   void translate( Shapes& shapes, const Vector3D& v )
+   void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
    {
       for( auto& shape : shapes )
       {
@@ -115,9 +113,303 @@ namespace classic_solution {
       }
    }
 
+
+   // Generalization to K shape types. The TranslateStrategy with K translate() overloads is
+   // generated by shape_types::Chain, one slot per shape type.
+   namespace generated {
+
+      template< size_t I, size_t K >
+      struct Primitive;
+
+
+      struct TranslateStrategyRoot
+      {
+         virtual ~TranslateStrategyRoot() {}
+
+         void translate() const = delete;
+      };
+
+      template< size_t K >
+      struct TranslateStrategySlots
+      {
+         template< size_t I, typename Base >
+         struct Slot : public Base
+         {
+            using Base::translate;
+            virtual void translate( Primitive<I,K>& primitive, const Vector3D& v ) const = 0;
+         };
+      };
+
+      template< size_t K >
+      using TranslateStrategy = shape_types::Chain_t< K, TranslateStrategySlots<K>::template Slot, TranslateStrategyRoot >;
+
+
+      struct Shape
+      {
+         Shape() = default;
+
+         virtual ~Shape() {}
+
+         virtual void translate( const Vector3D& v ) = 0;
+      };
+
+
+      template< size_t I, size_t K >
+      struct Primitive : public Shape
+      {
+         Primitive( double s, std::unique_ptr< TranslateStrategy<K> >&& ts )
+            : size( s )
+            , strategy( std::move(ts) )
+         {}
+
+         ~Primitive() {}
+
+         void translate( const Vector3D& v ) override { strategy->translate( *this, v ); }
+
+         double size;
+         Vector3D center{};
+         std::unique_ptr< TranslateStrategy<K> > strategy;
+      };
+
+
+      template< size_t K >
+      struct ConcreteTranslateStrategySlots
+      {
+         template< size_t I, typename Base >
+         struct Slot : public Base
+         {
+            using Base::translate;
+            void translate( Primitive<I,K>& primitive, const Vector3D& v ) const override
+            {
+               primitive.center = primitive.center + v;
+            }
+         };
+      };
+
+      template< size_t K >
+      using ConcreteTranslateStrategy = shape_types::Chain_t< K, ConcreteTranslateStrategySlots<K>::template Slot, TranslateStrategy<K> >;
+
+
+      template< size_t K >
+      using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+      void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
+      {
+         for( auto& shape : shapes )
+         {
+            shape->translate( v );
+         }
+      }
+
+   } // namespace generated
+
 } // namespace classic_solution
 
 
+namespace flyweight_solution {
+
+   struct Circle;
+   struct Square;
+
+   struct TranslateStrategy
+   {
+      virtual ~TranslateStrategy() {}
+
+      virtual void translate( Circle& circle, const Vector3D& v ) const = 0;
+      virtual void translate( Square& square, const Vector3D& v ) const = 0;
+   };
+
+
+   // Interns stateless strategies: the first request for a strategy type creates the one and only
+   // instance, every later request returns a reference to it. All shapes with the same strategy
+   // thus share a single object instead of owning one heap-allocated copy each.
+   template< typename Interface >
+   class StrategyRegistry
+   {
+    public:
+      template< typename Strategy >
+      const Interface& get()
+      {
+         std::unique_ptr<Interface>& strategy( strategies_[ std::type_index( typeid(Strategy) ) ] );
+         if( !strategy )
+            strategy = std::make_unique<Strategy>();
+         return *strategy;
+      }
+
+    private:
+      std::map< std::type_index, std::unique_ptr<Interface> > strategies_;
+   };
+
+   // The registry outlives all shapes, since shapes only hold non-owning references.
+   template< typename Interface >
+   StrategyRegistry<Interface>& registry()
+   {
+      static StrategyRegistry<Interface> strategies;
+      return strategies;
+   }
+
+
+   struct Shape
+   {
+      Shape() = default;
+
+      virtual ~Shape() {}
+
+      virtual void translate( const Vector3D& v ) = 0;
+   };
+
+
+   struct Circle : public Shape
+   {
+      Circle( double r, const TranslateStrategy& ts )
+         : radius( r )
+         , strategy( &ts )
+      {}
+
+      ~Circle() {}
+
+      void translate( const Vector3D& v ) override { strategy->translate( *this, v ); }
+
+      double radius;
+      Vector3D center{};
+      const TranslateStrategy* strategy;
+   };
+
+
+   struct Square : public Shape
+   {
+      Square( double s, const TranslateStrategy& ts )
+         : side( s )
+         , strategy( &ts )
+      {}
+
+      ~Square() {}
+
+      void translate( const Vector3D& v ) override { strategy->translate( *this, v ); }
+
+      double side;
+      Vector3D center{};
+      const TranslateStrategy* strategy;
+   };
+
+
+   struct ConcreteTranslateStrategy : public TranslateStrategy
+   {
+      virtual ~ConcreteTranslateStrategy() {}
+
+      void translate( Circle& circle, const Vector3D& v ) const override
+      {
+         circle.center = circle.center + v;
+      }
+
+      void translate( Square& square, const Vector3D& v ) const override
+      {
+         square.center = square.center + v;
+      }
+   };
+
+   using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+   void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
+   {
+      for( auto& shape : shapes )
+      {
+         shape->translate( v );
+      }
+   }
+
+
+   // Generalization to K shape types, analogous to classic_solution::generated.
+   namespace generated {
+
+      template< size_t I, size_t K >
+      struct Primitive;
+
+
+      struct TranslateStrategyRoot
+      {
+         virtual ~TranslateStrategyRoot() {}
+
+         void translate() const = delete;
+      };
+
+      template< size_t K >
+      struct TranslateStrategySlots
+      {
+         template< size_t I, typename Base >
+         struct Slot : public Base
+         {
+            using Base::translate;
+            virtual void translate( Primitive<I,K>& primitive, const Vector3D& v ) const = 0;
+         };
+      };
+
+      template< size_t K >
+      using TranslateStrategy = shape_types::Chain_t< K, TranslateStrategySlots<K>::template Slot, TranslateStrategyRoot >;
+
+
+      struct Shape
+      {
+         Shape() = default;
+
+         virtual ~Shape() {}
+
+         virtual void translate( const Vector3D& v ) = 0;
+      };
+
+
+      template< size_t I, size_t K >
+      struct Primitive : public Shape
+      {
+         Primitive( double s, const TranslateStrategy<K>& ts )
+            : size( s )
+            , strategy( &ts )
+         {}
+
+         ~Primitive() {}
+
+         void translate( const Vector3D& v ) override { strategy->translate( *this, v ); }
+
+         double size;
+         Vector3D center{};
+         const TranslateStrategy<K>* strategy;
+      };
+
+
+      template< size_t K >
+      struct ConcreteTranslateStrategySlots
+      {
+         template< size_t I, typename Base >
+         struct Slot : public Base
+         {
+            using Base::translate;
+            void translate( Primitive<I,K>& primitive, const Vector3D& v ) const override
+            {
+               primitive.center = primitive.center + v;
+            }
+         };
+      };
+
+      template< size_t K >
+      using ConcreteTranslateStrategy = shape_types::Chain_t< K, ConcreteTranslateStrategySlots<K>::template Slot, TranslateStrategy<K> >;
+
+
+      template< size_t K >
+      using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+      void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
+      {
+         for( auto& shape : shapes )
+         {
+            shape->translate( v );
+         }
+      }
+
+   } // namespace generated
+
+} // namespace flyweight_solution
+
+
 namespace std_function_solution {
 
    struct Shape
@@ -189,7 +481,7 @@ namespace std_function_solution {
 
    using Shapes = std::vector< std::unique_ptr<Shape> >;
 
-   void translate( Shapes& shapes, const Vector3D& v )
+   void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
    {
       for( auto& shape : shapes )
       {
@@ -197,42 +489,134 @@ namespace std_function_solution {
       }
    }
 
+
+   // Generalization to K shape types.
+   namespace generated {
+
+      struct Shape
+      {
+         Shape() = default;
+
+         virtual ~Shape() {}
+
+         virtual void translate( const Vector3D& v ) = 0;
+      };
+
+
+      template< size_t I >
+      struct Primitive : public Shape
+      {
+         using TranslateStrategy = std::function<void(Primitive&, const Vector3D&)>;
+
+         Primitive( double s, TranslateStrategy ts )
+            : size( s )
+            , strategy( std::move(ts) )
+         {}
+
+         ~Primitive() {}
+
+         void translate( const Vector3D& v ) override { strategy( *this, v ); }
+
+         double size;
+         Vector3D center;
+         TranslateStrategy strategy;
+      };
+
+      template< size_t I >
+      void translate( Primitive<I>& primitive, const Vector3D& v )
+      {
+         primitive.center = primitive.center + v;
+      }
+
+
+      struct Translate {
+         template< typename T >
+         void operator()( T& t, const Vector3D& v )
+         {
+            translate( t, v );
+         }
+      };
+
+
+      template< size_t K >
+      using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+      void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
+      {
+         for( auto& shape : shapes )
+         {
+            shape->translate( v );
+         }
+      }
+
+   } // namespace generated
+
 } // namespace std_function_solution
 
 
 namespace manual_function_solution {
 
-   template< typename Fn, size_t N >
+   template< typename Fn, size_t N, size_t Alignment = alignof(std::max_align_t), size_t Misalignment = 0UL
+           , size_t Padding = 0UL >
    class Function;
 
-   template< typename R, typename... Args, size_t N >
-   class Function<R(Args...),N>
+   // A type-erased callable with a small buffer for callables of up to N bytes. The buffer is
+   // aligned to Alignment bytes. Callables that do not fit into the buffer, that need a stricter
+   // alignment, or that could throw while being moved, are allocated on the heap. Moving a
+   // Function never throws; a moved-from Function is empty and must not be called.
+   //
+   // Misalignment and Padding are only meant for measuring the cost of misaligned storage: the
+   // buffer is extended by Padding bytes and the callable is placed Misalignment bytes past its
+   // aligned start. Giving the aligned and the misaligned variant the same Padding keeps their
+   // sizes equal. Any Misalignment other than 0 is undefined behavior and only tolerated by
+   // platforms with unaligned loads (e.g. x86).
+   template< typename R, typename... Args, size_t N, size_t Alignment, size_t Misalignment, size_t Padding >
+   class Function<R(Args...),N,Alignment,Misalignment,Padding>
    {
+      static_assert( Alignment > 0UL && ( Alignment & ( Alignment-1UL ) ) == 0UL, "Alignment must be a power of two" );
+      static_assert( Misalignment <= Padding, "Misalignment must not exceed the padding of the buffer" );
+
     public:
-      template< typename Fn >
-      Function( Fn fn )
-         : pimpl_{ reinterpret_cast<Concept*>( buffer ) }
+      template< typename Fn
+              , typename = std::enable_if_t< !std::is_same< std::decay_t<Fn>, Function >::value > >
+      Function( Fn&& fn )
+      {
+         emplace< std::decay_t<Fn> >( std::forward<Fn>( fn ) );
+      }
+
+      Function( const Function& f )
       {
-         static_assert( sizeof(Fn) <= N, "Given type is too large" );
-         new (pimpl_) Model<Fn>( fn );
+         if( f.pimpl_ )
+            f.pimpl_->clone( *this );
       }
 
-      Function( Function const& f )
-         : pimpl_{ reinterpret_cast<Concept*>( buffer ) }
+      Function( Function&& f ) noexcept
       {
-         f.pimpl_->clone( pimpl_ );
+         steal( f );
+      }
+
+      Function& operator=( const Function& f )
+      {
+         if( this != &f ) {
+            Function tmp( f );
+            reset();
+            steal( tmp );
+         }
+         return *this;
       }
 
-      Function& operator=( Function f )
+      Function& operator=( Function&& f ) noexcept
       {
-         pimpl_->~Concept();
-         f.pimpl_->clone( pimpl_ );
+         if( this != &f ) {
+            reset();
+            steal( f );
+         }
          return *this;
       }
 
-      ~Function() { pimpl_->~Concept(); }
+      ~Function() { reset(); }
 
-      R operator()( Args... args ) { return (*pimpl_)( std::forward<Args>( args )... ); }
+      R operator()( Args... args ) const { return (*pimpl_)( std::forward<Args>( args )... ); }
 
     private:
       class Concept
@@ -240,27 +624,76 @@ namespace manual_function_solution {
        public:
          virtual ~Concept() = default;
          virtual R operator()( Args... ) const = 0;
-         virtual void clone( Concept* memory ) const = 0;
+         virtual void clone( Function& target ) const = 0;
+         virtual Concept* move( void* memory ) noexcept = 0;
       };
 
       template< typename Fn >
       class Model : public Concept
       {
        public:
-         explicit Model( Fn fn )
-            : fn_( fn )
+         template< typename F >
+         explicit Model( F&& fn )
+            : fn_( std::forward<F>( fn ) )
          {}
 
          R operator()( Args... args ) const override { return fn_( std::forward<Args>( args )... ); }
-         void clone( Concept* memory ) const override { new (memory) Model( fn_ ); }
+         void clone( Function& target ) const override { target.template emplace<Fn>( fn_ ); }
+         Concept* move( void* memory ) noexcept override { return new (memory) Model( std::move( fn_ ) ); }
 
        private:
          Fn fn_;
       };
 
-      Concept* pimpl_;
+      // The buffer holds the callable plus the vtable pointer of its model.
+      static constexpr size_t capacity = N + sizeof(void*);
+
+      template< typename Fn >
+      static constexpr bool is_small = sizeof(Model<Fn>) <= capacity && alignof(Model<Fn>) <= Alignment
+                                    && std::is_nothrow_move_constructible<Fn>::value;
+
+      template< typename Fn, typename F >
+      void emplace( F&& fn )
+      {
+         if constexpr( is_small<Fn> )
+            pimpl_ = new (storage()) Model<Fn>( std::forward<F>( fn ) );
+         else
+            pimpl_ = new Model<Fn>( std::forward<F>( fn ) );
+      }
+
+      void* storage() noexcept { return buffer_ + Misalignment; }
+
+      bool is_local() const noexcept
+      {
+         return static_cast<const void*>( pimpl_ ) == static_cast<const void*>( buffer_ + Misalignment );
+      }
+
+      // Takes over the callable of f and leaves f empty. A callable on the heap is not moved at
+      // all, only the pointer to it.
+      void steal( Function& f ) noexcept
+      {
+         if( f.is_local() ) {
+            pimpl_ = f.pimpl_->move( storage() );
+            f.reset();
+         }
+         else {
+            pimpl_ = f.pimpl_;
+            f.pimpl_ = nullptr;
+         }
+      }
+
+      void reset() noexcept
+      {
+         if( is_local() )
+            pimpl_->~Concept();
+         else
+            delete pimpl_;
+         pimpl_ = nullptr;
+      }
+
+      Concept* pimpl_{ nullptr };
 
-      char buffer[N+8UL];
+      alignas(Alignment) unsigned char buffer_[capacity+Padding];
    };
 
 
@@ -274,16 +707,20 @@ namespace manual_function_solution {
    };
 
 
-   struct Circle : public Shape
+   // The shapes are templates on the misalignment and padding of their strategy's storage, such
+   // that the benchmark can compare aligned (0) and deliberately misaligned storage of the same
+   // strategy in shapes of the same size.
+   template< size_t Misalignment, size_t Padding = 0UL >
+   struct BasicCircle : public Shape
    {
-      using TranslateStrategy = Function<void(Circle&, const Vector3D&),8UL>;
+      using TranslateStrategy = Function<void(BasicCircle&, const Vector3D&),8UL,alignof(std::max_align_t),Misalignment,Padding>;
 
-      Circle( double r, TranslateStrategy ts )
+      BasicCircle( double r, TranslateStrategy ts )
          : radius{ r }
          , strategy{ std::move(ts) }
       {}
 
-      ~Circle() {}
+      ~BasicCircle() {}
 
       void translate( const Vector3D& v ) override { strategy( *this, v ); }
 
@@ -292,22 +729,26 @@ namespace manual_function_solution {
       TranslateStrategy strategy;
    };
 
-   void translate( Circle& circle, const Vector3D& v )
+   using Circle = BasicCircle<0UL>;
+
+   template< size_t Misalignment, size_t Padding >
+   void translate( BasicCircle<Misalignment,Padding>& circle, const Vector3D& v )
    {
       circle.center = circle.center + v;
    }
 
 
-   struct Square : public Shape
+   template< size_t Misalignment, size_t Padding = 0UL >
+   struct BasicSquare : public Shape
    {
-      using TranslateStrategy = Function<void(Square&, const Vector3D&),8UL>;
+      using TranslateStrategy = Function<void(BasicSquare&, const Vector3D&),8UL,alignof(std::max_align_t),Misalignment,Padding>;
 
-      Square( double s, TranslateStrategy ts )
+      BasicSquare( double s, TranslateStrategy ts )
          : side{ s }
          , strategy{ std::move(ts) }
       {}
 
-      ~Square() {}
+      ~BasicSquare() {}
 
       void translate( const Vector3D& v ) override { strategy( *this, v ); }
 
@@ -316,7 +757,13 @@ namespace manual_function_solution {
       TranslateStrategy strategy;
    };
 
-   void translate( Square& square, const Vector3D& v )
+   using Square = BasicSquare<0UL>;
+
+   static_assert( sizeof(BasicCircle<0UL,alignof(std::max_align_t)>) == sizeof(BasicCircle<1UL,alignof(std::max_align_t)>)
+                , "The aligned and the misaligned variant must only differ in alignment" );
+
+   template< size_t Misalignment, size_t Padding >
+   void translate( BasicSquare<Misalignment,Padding>& square, const Vector3D& v )
    {
       square.center = square.center + v;
    }
@@ -333,7 +780,7 @@ namespace manual_function_solution {
 
    using Shapes = std::vector< std::unique_ptr<Shape> >;
 
-   void translate( Shapes& shapes, const Vector3D& v )
+   void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
    {
       for( auto& shape : shapes )
       {
@@ -341,106 +788,1228 @@ namespace manual_function_solution {
       }
    }
 
-} // namespace manual_function_solution
 
+   // Generalization to K shape types.
+   namespace generated {
 
-int main()
-{
-   const size_t N    ( 100UL );
-   const size_t steps( 2500000UL );
+      struct Shape
+      {
+         Shape() = default;
 
-   std::random_device rd{};
-   const unsigned int seed( rd() );
+         virtual ~Shape() {}
 
-   std::mt19937 rng{};
-   std::uniform_real_distribution<double> dist( 0.0, 1.0 );
+         virtual void translate( const Vector3D& v ) = 0;
+      };
 
-   {
-      using namespace classic_solution;
 
-      rng.seed( seed );
+      template< size_t I >
+      struct Primitive : public Shape
+      {
+         using TranslateStrategy = Function<void(Primitive&, const Vector3D&),8UL>;
 
-      Shapes shapes;
+         Primitive( double s, TranslateStrategy ts )
+            : size{ s }
+            , strategy{ std::move(ts) }
+         {}
 
-      for( size_t i=0UL; i<N; ++i ) {
-         if( dist( rng ) < 0.5 )
-            shapes.push_back( std::make_unique<Circle>( dist( rng )
-                                                      , std::make_unique<ConcreteTranslateStrategy>() ) );
-         else
-            shapes.push_back( std::make_unique<Square>( dist( rng )
-                                                      , std::make_unique<ConcreteTranslateStrategy>() ) );
-      }
+         ~Primitive() {}
+
+         void translate( const Vector3D& v ) override { strategy( *this, v ); }
 
-      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
-      start = std::chrono::high_resolution_clock::now();
+         double size;
+         Vector3D center;
+         TranslateStrategy strategy;
+      };
 
-      for( size_t s=0UL; s<steps; ++s ) {
-         translate( shapes, Vector3D{ dist( rng ), dist( rng ) } );
+      template< size_t I >
+      void translate( Primitive<I>& primitive, const Vector3D& v )
+      {
+         primitive.center = primitive.center + v;
       }
 
-      end = std::chrono::high_resolution_clock::now();
-      const std::chrono::duration<double> elapsedTime( end - start );
-      const double seconds( elapsedTime.count() );
 
-      std::cout << " Classic solution runtime         : " << seconds << "s\n";
-   }
+      struct Translate {
+         template< typename T >
+         void operator()( T& t, const Vector3D& v ) const
+         {
+            translate( t, v );
+         }
+      };
 
+
+      template< size_t K >
+      using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+      void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
+      {
+         for( auto& shape : shapes )
+         {
+            shape->translate( v );
+         }
+      }
+
+   } // namespace generated
+
+} // namespace manual_function_solution
+
+
+namespace vtable_function_solution {
+
+   template< typename Fn, size_t N, size_t Alignment = alignof(std::max_align_t) >
+   class Function;
+
+   // A type-erased callable like manual_function_solution::Function, but without virtual functions:
+   // the object holds the invoke function pointer inline and a pointer to a static per-type table
+   // of the remaining operations (clone, move, destroy). A call is a single indirect jump through
+   // the invoke pointer stored next to the callable, instead of loading pimpl_, then the vptr of
+   // the model, then the slot. Callables that do not fit into the N-byte buffer, need a stricter
+   // alignment or could throw while being moved are allocated on the heap.
+   template< typename R, typename... Args, size_t N, size_t Alignment >
+   class Function<R(Args...),N,Alignment>
+   {
+    public:
+      template< typename Fn
+              , typename = std::enable_if_t< !std::is_same< std::decay_t<Fn>, Function >::value > >
+      Function( Fn&& fn )
+      {
+         using Handler = std::conditional_t< is_small< std::decay_t<Fn> >, Local< std::decay_t<Fn> >, Remote< std::decay_t<Fn> > >;
+         Handler::create( buffer_, std::forward<Fn>( fn ) );
+         invoke_ = &Handler::invoke;
+         table_  = &table<Handler>;
+      }
+
+      Function( const Function& f )
+      {
+         if( f.table_ ) {
+            f.table_->clone( f.buffer_, buffer_ );
+            invoke_ = f.invoke_;
+            table_  = f.table_;
+         }
+      }
+
+      Function( Function&& f ) noexcept
+      {
+         steal( f );
+      }
+
+      Function& operator=( const Function& f )
+      {
+         if( this != &f ) {
+            Function tmp( f );
+            reset();
+            steal( tmp );
+         }
+         return *this;
+      }
+
+      Function& operator=( Function&& f ) noexcept
+      {
+         if( this != &f ) {
+            reset();
+            steal( f );
+         }
+         return *this;
+      }
+
+      ~Function() { reset(); }
+
+      R operator()( Args... args ) const { return invoke_( buffer_, std::forward<Args>( args )... ); }
+
+    private:
+      struct Table
+      {
+         void (*clone)( const void* from, void* to );
+         void (*move)( void* from, void* to ) noexcept;  // Also destroys the callable in from
+         void (*destroy)( void* memory ) noexcept;
+      };
+
+      // The callable is stored in the buffer itself.
+      template< typename Fn >
+      struct Local
+      {
+         static const Fn& get( const void* memory ) { return *std::launder( static_cast<const Fn*>( memory ) ); }
+         static Fn& get( void* memory ) { return *std::launder( static_cast<Fn*>( memory ) ); }
+
+         template< typename F >
+         static void create( void* memory, F&& fn ) { new (memory) Fn( std::forward<F>( fn ) ); }
+
+         static R invoke( const void* memory, Args... args ) { return get( memory )( std::forward<Args>( args )... ); }
+         static void clone( const void* from, void* to ) { new (to) Fn( get( from ) ); }
+         static void move( void* from, void* to ) noexcept { new (to) Fn( std::move( get( from ) ) ); get( from ).~Fn(); }
+         static void destroy( void* memory ) noexcept { get( memory ).~Fn(); }
+      };
+
+      // The buffer stores a pointer to the callable on the heap.
+      template< typename Fn >
+      struct Remote
+      {
+         static Fn* get( const void* memory ) { return *std::launder( static_cast<Fn* const*>( memory ) ); }
+
+         template< typename F >
+         static void create( void* memory, F&& fn ) { new (memory) Fn*( new Fn( std::forward<F>( fn ) ) ); }
+
+         static R invoke( const void* memory, Args... args ) { return (*get( memory ))( std::forward<Args>( args )... ); }
+         static void clone( const void* from, void* to ) { new (to) Fn*( new Fn( *get( from ) ) ); }
+         static void move( void* from, void* to ) noexcept { new (to) Fn*( get( from ) ); }
+         static void destroy( void* memory ) noexcept { delete get( memory ); }
+      };
+
+      template< typename Handler >
+      static constexpr Table table{ &Handler::clone, &Handler::move, &Handler::destroy };
+
+      static constexpr size_t capacity = N < sizeof(void*) ? sizeof(void*) : N;
+
+      template< typename Fn >
+      static constexpr bool is_small = sizeof(Fn) <= capacity && alignof(Fn) <= Alignment
+                                    && std::is_nothrow_move_constructible<Fn>::value;
+
+      // Takes over the callable of f and leaves f empty.
+      void steal( Function& f ) noexcept
+      {
+         if( f.table_ ) {
+            f.table_->move( f.buffer_, buffer_ );
+            invoke_ = f.invoke_;
+            table_  = f.table_;
+            f.invoke_ = nullptr;
+            f.table_  = nullptr;
+         }
+      }
+
+      void reset() noexcept
+      {
+         if( table_ ) {
+            table_->destroy( buffer_ );
+            invoke_ = nullptr;
+            table_  = nullptr;
+         }
+      }
+
+      R (*invoke_)( const void*, Args... ){ nullptr };
+      const Table* table_{ nullptr };
+
+      alignas(Alignment) unsigned char buffer_[capacity];
+   };
+
+
+   struct Shape
+   {
+      Shape() = default;
+
+      virtual ~Shape() {}
+
+      virtual void translate( const Vector3D& v ) = 0;
+   };
+
+
+   struct Circle : public Shape
+   {
+      using TranslateStrategy = Function<void(Circle&, const Vector3D&),8UL>;
+
+      Circle( double r, TranslateStrategy ts )
+         : radius{ r }
+         , strategy{ std::move(ts) }
+      {}
+
+      ~Circle() {}
+
+      void translate( const Vector3D& v ) override { strategy( *this, v ); }
+
+      double radius;
+      Vector3D center;
+      TranslateStrategy strategy;
+   };
+
+   void translate( Circle& circle, const Vector3D& v )
+   {
+      circle.center = circle.center + v;
+   }
+
+
+   struct Square : public Shape
+   {
+      using TranslateStrategy = Function<void(Square&, const Vector3D&),8UL>;
+
+      Square( double s, TranslateStrategy ts )
+         : side{ s }
+         , strategy{ std::move(ts) }
+      {}
+
+      ~Square() {}
+
+      void translate( const Vector3D& v ) override { strategy( *this, v ); }
+
+      double side;
+      Vector3D center;
+      TranslateStrategy strategy;
+   };
+
+   void translate( Square& square, const Vector3D& v )
+   {
+      square.center = square.center + v;
+   }
+
+
+   struct Translate {
+      template< typename T >
+      void operator()( T& t, const Vector3D& v ) const
+      {
+         translate( t, v );
+      }
+   };
+
+
+   using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+   void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
+   {
+      for( auto& shape : shapes )
+      {
+         shape->translate( v );
+      }
+   }
+
+
+   // Generalization to K shape types.
+   namespace generated {
+
+      struct Shape
+      {
+         Shape() = default;
+
+         virtual ~Shape() {}
+
+         virtual void translate( const Vector3D& v ) = 0;
+      };
+
+
+      template< size_t I >
+      struct Primitive : public Shape
+      {
+         using TranslateStrategy = Function<void(Primitive&, const Vector3D&),8UL>;
+
+         Primitive( double s, TranslateStrategy ts )
+            : size{ s }
+            , strategy{ std::move(ts) }
+         {}
+
+         ~Primitive() {}
+
+         void translate( const Vector3D& v ) override { strategy( *this, v ); }
+
+         double size;
+         Vector3D center;
+         TranslateStrategy strategy;
+      };
+
+      template< size_t I >
+      void translate( Primitive<I>& primitive, const Vector3D& v )
+      {
+         primitive.center = primitive.center + v;
+      }
+
+
+      struct Translate {
+         template< typename T >
+         void operator()( T& t, const Vector3D& v ) const
+         {
+            translate( t, v );
+         }
+      };
+
+
+      template< size_t K >
+      using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+      void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
+      {
+         for( auto& shape : shapes )
+         {
+            shape->translate( v );
+         }
+      }
+
+   } // namespace generated
+
+} // namespace vtable_function_solution
+
+
+namespace function_ref_solution {
+
+   template< typename Fn >
+   class FunctionRef;
+
+   // A non-owning reference to a callable: an object pointer plus a thunk that casts the pointer
+   // back to the callable's type and calls it. FunctionRef is trivially copyable and as large as
+   // two pointers. The referenced callable must outlive all FunctionRefs to it.
+   template< typename R, typename... Args >
+   class FunctionRef<R(Args...)>
+   {
+    public:
+      template< typename Fn
+              , typename = std::enable_if_t< !std::is_same< std::remove_cv_t<Fn>, FunctionRef >::value > >
+      FunctionRef( Fn& fn ) noexcept
+         : object_{ const_cast<void*>( static_cast<const void*>( std::addressof( fn ) ) ) }
+         , thunk_{ &invoke<Fn> }
+      {}
+
+      R operator()( Args... args ) const { return thunk_( object_, std::forward<Args>( args )... ); }
+
+    private:
+      template< typename Fn >
+      static R invoke( void* object, Args... args )
+      {
+         return (*static_cast<Fn*>( object ))( std::forward<Args>( args )... );
+      }
+
+      void* object_;
+      R (*thunk_)( void*, Args... );
+   };
+
+   static_assert( sizeof(FunctionRef<void()>) == 2UL*sizeof(void*), "FunctionRef must be two pointers" );
+   static_assert( std::is_trivially_copyable< FunctionRef<void()> >::value, "FunctionRef must be trivially copyable" );
+
+
+   struct Shape
+   {
+      Shape() = default;
+
+      virtual ~Shape() {}
+
+      virtual void translate( const Vector3D& v ) = 0;
+   };
+
+
+   struct Circle : public Shape
+   {
+      using TranslateStrategy = FunctionRef<void(Circle&, const Vector3D&)>;
+
+      Circle( double r, TranslateStrategy ts )
+         : radius{ r }
+         , strategy{ std::move(ts) }
+      {}
+
+      ~Circle() {}
+
+      void translate( const Vector3D& v ) override { strategy( *this, v ); }
+
+      double radius;
+      Vector3D center;
+      TranslateStrategy strategy;
+   };
+
+   void translate( Circle& circle, const Vector3D& v )
+   {
+      circle.center = circle.center + v;
+   }
+
+
+   struct Square : public Shape
+   {
+      using TranslateStrategy = FunctionRef<void(Square&, const Vector3D&)>;
+
+      Square( double s, TranslateStrategy ts )
+         : side{ s }
+         , strategy{ std::move(ts) }
+      {}
+
+      ~Square() {}
+
+      void translate( const Vector3D& v ) override { strategy( *this, v ); }
+
+      double side;
+      Vector3D center;
+      TranslateStrategy strategy;
+   };
+
+   void translate( Square& square, const Vector3D& v )
+   {
+      square.center = square.center + v;
+   }
+
+
+   struct Translate {
+      template< typename T >
+      void operator()( T& t, const Vector3D& v ) const
+      {
+         translate( t, v );
+      }
+   };
+
+   // The strategy all shapes refer to; it outlives every shape.
+   const Translate strategy{};
+
+
+   using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+   void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
+   {
+      for( auto& shape : shapes )
+      {
+         shape->translate( v );
+      }
+   }
+
+
+   // Generalization to K shape types.
+   namespace generated {
+
+      struct Shape
+      {
+         Shape() = default;
+
+         virtual ~Shape() {}
+
+         virtual void translate( const Vector3D& v ) = 0;
+      };
+
+
+      template< size_t I >
+      struct Primitive : public Shape
+      {
+         using TranslateStrategy = FunctionRef<void(Primitive&, const Vector3D&)>;
+
+         Primitive( double s, TranslateStrategy ts )
+            : size{ s }
+            , strategy{ std::move(ts) }
+         {}
+
+         ~Primitive() {}
+
+         void translate( const Vector3D& v ) override { strategy( *this, v ); }
+
+         double size;
+         Vector3D center;
+         TranslateStrategy strategy;
+      };
+
+      template< size_t I >
+      void translate( Primitive<I>& primitive, const Vector3D& v )
+      {
+         primitive.center = primitive.center + v;
+      }
+
+
+      struct Translate {
+         template< typename T >
+         void operator()( T& t, const Vector3D& v ) const
+         {
+            translate( t, v );
+         }
+      };
+
+      const Translate strategy{};
+
+
+      template< size_t K >
+      using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+      void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
+      {
+         for( auto& shape : shapes )
+         {
+            shape->translate( v );
+         }
+      }
+
+   } // namespace generated
+
+} // namespace function_ref_solution
+
+
+namespace type_partitioned_solution {
+
+   struct Circle
+   {
+      double radius{};
+      Vector3D center{};
+   };
+
+   void translate( Circle& c, const Vector3D& v )
+   {
+      c.center = c.center + v;
+   }
+
+
+   struct Square
+   {
+      double side{};
+      Vector3D center{};
+   };
+
+   void translate( Square& s, const Vector3D& v )
+   {
+      s.center = s.center + v;
+   }
+
+
+   using Shapes = poly::Collection<Circle,Square>;
+
+   void translate( Shapes& shapes, const Vector3D& v )
+   {
+      shapes.for_each( [&]( auto& shape ){ translate( shape, v ); } );
+   }
+
+   void translate( Shapes& shapes, const Vector3D& v, size_t begin, size_t end )
+   {
+      shapes.for_each( [&]( auto& shape ){ translate( shape, v ); }, begin, end );
+   }
+
+
+   // Generalization to K shape types, i.e. a collection with K segments.
+   namespace generated {
+
+      template< size_t I >
+      struct Primitive
+      {
+         double size{};
+         Vector3D center{};
+      };
+
+      template< size_t I >
+      void translate( Primitive<I>& p, const Vector3D& v )
+      {
+         p.center = p.center + v;
+      }
+
+
+      template< size_t K >
+      using Shapes = shape_types::VariantOf_t< K, poly::Collection, Primitive >;
+
+      template< typename... Ts >
+      void translate( poly::Collection<Ts...>& shapes, const Vector3D& v )
+      {
+         shapes.for_each( [&]( auto& shape ){ translate( shape, v ); } );
+      }
+
+      template< typename... Ts >
+      void translate( poly::Collection<Ts...>& shapes, const Vector3D& v, size_t begin, size_t end )
+      {
+         shapes.for_each( [&]( auto& shape ){ translate( shape, v ); }, begin, end );
+      }
+
+   } // namespace generated
+
+} // namespace type_partitioned_solution
+
+
+namespace policy_solution {
+
+   // The strategy is a template parameter of the shapes and is hence resolved at compile time:
+   // there is no indirect call, and the translation is fully inlined into the loop over each
+   // segment of the type-partitioned container. The price is one instantiation of every shape
+   // (and every function using it) per strategy.
+   template< typename TranslatePolicy >
+   struct Circle
    {
-      using namespace std_function_solution;
+      void translate( const Vector3D& v ) { policy( *this, v ); }
+
+      double radius{};
+      Vector3D center{};
+      [[no_unique_address]] TranslatePolicy policy{};
+   };
 
-      rng.seed( seed );
 
-      Shapes shapes;
+   template< typename TranslatePolicy >
+   struct Square
+   {
+      void translate( const Vector3D& v ) { policy( *this, v ); }
 
-      for( size_t i=0UL; i<N; ++i ) {
-         if( dist( rng ) < 0.5 )
-            shapes.push_back( std::make_unique<Circle>( dist( rng ), Translate{} ) );
-         else
-            shapes.push_back( std::make_unique<Square>( dist( rng ), Translate{} ) );
+      double side{};
+      Vector3D center{};
+      [[no_unique_address]] TranslatePolicy policy{};
+   };
+
+
+   struct ConcreteTranslatePolicy
+   {
+      template< typename T >
+      void operator()( T& t, const Vector3D& v ) const
+      {
+         t.center = t.center + v;
+      }
+   };
+
+
+   template< typename TranslatePolicy >
+   using ShapesWith = poly::Collection< Circle<TranslatePolicy>, Square<TranslatePolicy> >;
+
+   using Shapes = ShapesWith<ConcreteTranslatePolicy>;
+
+   template< typename... Ts >
+   void translate( poly::Collection<Ts...>& shapes, const Vector3D& v )
+   {
+      shapes.for_each( [&]( auto& shape ){ shape.translate( v ); } );
+   }
+
+   template< typename... Ts >
+   void translate( poly::Collection<Ts...>& shapes, const Vector3D& v, size_t begin, size_t end )
+   {
+      shapes.for_each( [&]( auto& shape ){ shape.translate( v ); }, begin, end );
+   }
+
+
+   // Generalization to K shape types, i.e. K shape templates with the same policy.
+   namespace generated {
+
+      template< size_t I, typename TranslatePolicy >
+      struct Primitive
+      {
+         void translate( const Vector3D& v ) { policy( *this, v ); }
+
+         double size{};
+         Vector3D center{};
+         [[no_unique_address]] TranslatePolicy policy{};
+      };
+
+      template< size_t I >
+      using ConcretePrimitive = Primitive< I, ConcreteTranslatePolicy >;
+
+
+      template< size_t K >
+      using Shapes = shape_types::VariantOf_t< K, poly::Collection, ConcretePrimitive >;
+
+      using policy_solution::translate;
+
+   } // namespace generated
+
+} // namespace policy_solution
+
+
+namespace batch_strategy_solution {
+
+   struct Circle
+   {
+      double radius{};
+      Vector3D center{};
+   };
+
+   struct Square
+   {
+      double side{};
+      Vector3D center{};
+   };
+
+
+   // The strategy translates a whole batch of shapes of the same type per virtual call.
+   struct TranslateStrategy
+   {
+      virtual ~TranslateStrategy() {}
+
+      virtual void translate( std::span<Circle> circles, const Vector3D& v ) const = 0;
+      virtual void translate( std::span<Square> squares, const Vector3D& v ) const = 0;
+   };
+
+
+   struct ConcreteTranslateStrategy : public TranslateStrategy
+   {
+      virtual ~ConcreteTranslateStrategy() {}
+
+      void translate( std::span<Circle> circles, const Vector3D& v ) const override
+      {
+         for( Circle& circle : circles ) {
+            circle.center = circle.center + v;
+         }
+      }
+
+      void translate( std::span<Square> squares, const Vector3D& v ) const override
+      {
+         for( Square& square : squares ) {
+            square.center = square.center + v;
+         }
+      }
+   };
+
+
+   // Shapes grouped by their strategy: every group owns a strategy and one contiguous segment per
+   // shape type, such that a translation costs one virtual call per group and shape type instead
+   // of one per shape. Shapes that are added with the same strategy object share a group.
+   template< typename Strategy, typename Collection >
+   class GroupedShapes
+   {
+    public:
+      template< typename T >
+      void push_back( T&& shape, const std::shared_ptr<const Strategy>& strategy )
+      {
+         group( strategy ).shapes.push_back( std::forward<T>( shape ) );
+      }
+
+      void translate( const Vector3D& v )
+      {
+         for( Group& g : groups_ )
+         {
+            g.shapes.for_each_segment( [&]( auto& segment ){
+               using T = typename std::decay_t<decltype(segment)>::value_type;
+               if( !segment.empty() )
+                  g.strategy->translate( std::span<T>( segment ), v );
+            } );
+         }
+      }
+
+      // Translates the shapes [begin,end), counted over all groups and segments in order.
+      void translate( const Vector3D& v, size_t begin, size_t end )
+      {
+         size_t first( 0UL );
+
+         for( Group& g : groups_ )
+         {
+            const size_t size( g.shapes.size() );
+
+            if( first < end && begin < first+size )
+            {
+               const size_t b( std::max( begin, first ) - first );
+               const size_t e( std::min( end, first+size ) - first );
+
+               g.shapes.for_each_segment( [&]( auto& segment, size_t offset ){
+                  using T = typename std::decay_t<decltype(segment)>::value_type;
+                  const size_t sb( std::max( b, offset ) - offset );
+                  const size_t se( std::min( e, offset+segment.size() ) - offset );
+                  g.strategy->translate( std::span<T>( segment.data()+sb, se-sb ), v );
+               }, b, e );
+            }
+
+            first += size;
+         }
       }
 
-      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
-      start = std::chrono::high_resolution_clock::now();
+      size_t groups() const { return groups_.size(); }
 
-      for( size_t s=0UL; s<steps; ++s ) {
-         translate( shapes, Vector3D{ dist( rng ), dist( rng ) } );
+    private:
+      struct Group
+      {
+         std::shared_ptr<const Strategy> strategy;
+         Collection shapes;
+      };
+
+      Group& group( const std::shared_ptr<const Strategy>& strategy )
+      {
+         for( Group& g : groups_ ) {
+            if( g.strategy == strategy )
+               return g;
+         }
+         groups_.push_back( Group{ strategy, Collection{} } );
+         return groups_.back();
       }
 
-      end = std::chrono::high_resolution_clock::now();
-      const std::chrono::duration<double> elapsedTime( end - start );
-      const double seconds( elapsedTime.count() );
+      std::vector<Group> groups_;
+   };
+
+   template< typename Strategy, typename Collection >
+   void translate( GroupedShapes<Strategy,Collection>& shapes, const Vector3D& v )
+   {
+      shapes.translate( v );
+   }
 
-      std::cout << " std::function solution runtime   : " << seconds << "s\n";
+   template< typename Strategy, typename Collection >
+   void translate( GroupedShapes<Strategy,Collection>& shapes, const Vector3D& v, size_t begin, size_t end )
+   {
+      shapes.translate( v, begin, end );
    }
 
+
+   using Shapes = GroupedShapes< TranslateStrategy, poly::Collection<Circle,Square> >;
+
+
+   // Generalization to K shape types. The TranslateStrategy with K batch translate() overloads is
+   // generated by shape_types::Chain, one slot per shape type.
+   namespace generated {
+
+      template< size_t I >
+      struct Primitive
+      {
+         double size{};
+         Vector3D center{};
+      };
+
+
+      struct TranslateStrategyRoot
+      {
+         virtual ~TranslateStrategyRoot() {}
+
+         void translate() const = delete;
+      };
+
+      template< size_t I, typename Base >
+      struct TranslateStrategySlot : public Base
+      {
+         using Base::translate;
+         virtual void translate( std::span< Primitive<I> > primitives, const Vector3D& v ) const = 0;
+      };
+
+      template< size_t K >
+      using TranslateStrategy = shape_types::Chain_t< K, TranslateStrategySlot, TranslateStrategyRoot >;
+
+
+      template< size_t K >
+      struct ConcreteTranslateStrategySlots
+      {
+         template< size_t I, typename Base >
+         struct Slot : public Base
+         {
+            using Base::translate;
+            void translate( std::span< Primitive<I> > primitives, const Vector3D& v ) const override
+            {
+               for( Primitive<I>& primitive : primitives ) {
+                  primitive.center = primitive.center + v;
+               }
+            }
+         };
+      };
+
+      template< size_t K >
+      using ConcreteTranslateStrategy = shape_types::Chain_t< K, ConcreteTranslateStrategySlots<K>::template Slot, TranslateStrategy<K> >;
+
+
+      template< size_t K >
+      using Shapes = GroupedShapes< TranslateStrategy<K>, shape_types::VariantOf_t< K, poly::Collection, Primitive > >;
+
+   } // namespace generated
+
+} // namespace batch_strategy_solution
+
+
+namespace soa_solution {
+
+   // The shapes are stored as a structure of arrays (see ShapeStore.hpp), such that a translation
+   // is a vectorized pass over the x, y and z arrays instead of a dispatch per shape. The shape
+   // type is only kept as data; the translation does not depend on it.
+   using Shapes = soa::ShapeStore;
+
+   using soa::translate;
+
+} // namespace soa_solution
+
+
+int main( int argc, char** argv )
+{
+   benchmark::Suite<Vector3D> suite( "Strategy_Benchmark" );
+
+   suite.add( "classic_solution", "Classic solution", []( const benchmark::ShapeSpec& spec ) -> classic_solution::Shapes::value_type
+   {
+      using namespace classic_solution;
+
+      if( spec.kind == benchmark::ShapeKind::circle )
+         return std::make_unique<Circle>( spec.size, std::make_unique<ConcreteTranslateStrategy>() );
+      else
+         return std::make_unique<Square>( spec.size, std::make_unique<ConcreteTranslateStrategy>() );
+   } );
+
+   suite.add( "flyweight_solution", "Flyweight solution", []( const benchmark::ShapeSpec& spec ) -> flyweight_solution::Shapes::value_type
+   {
+      using namespace flyweight_solution;
+
+      const TranslateStrategy& strategy( registry<TranslateStrategy>().get<ConcreteTranslateStrategy>() );
+
+      if( spec.kind == benchmark::ShapeKind::circle )
+         return std::make_unique<Circle>( spec.size, strategy );
+      else
+         return std::make_unique<Square>( spec.size, strategy );
+   } );
+
+   suite.add( "std_function_solution", "std::function solution", []( const benchmark::ShapeSpec& spec ) -> std_function_solution::Shapes::value_type
+   {
+      using namespace std_function_solution;
+
+      if( spec.kind == benchmark::ShapeKind::circle )
+         return std::make_unique<Circle>( spec.size, Translate{} );
+      else
+         return std::make_unique<Square>( spec.size, Translate{} );
+   } );
+
+   suite.add( "manual_function_solution", "Manual function solution", []( const benchmark::ShapeSpec& spec ) -> manual_function_solution::Shapes::value_type
+   {
+      using namespace manual_function_solution;
+
+      if( spec.kind == benchmark::ShapeKind::circle )
+         return std::make_unique<Circle>( spec.size, Translate{} );
+      else
+         return std::make_unique<Square>( spec.size, Translate{} );
+   } );
+
+   // The aligned counterpart of the misaligned solution: the same padded buffer, but the strategy
+   // at its aligned start, such that the two only differ in the alignment of the strategy.
+   suite.add_opt_in( "manual_function_padded_solution", "Manual function (padded)", []( const benchmark::ShapeSpec& spec ) -> manual_function_solution::Shapes::value_type
+   {
+      using namespace manual_function_solution;
+
+      constexpr size_t padding( alignof(std::max_align_t) );
+
+      if( spec.kind == benchmark::ShapeKind::circle )
+         return std::make_unique< BasicCircle<0UL,padding> >( spec.size, Translate{} );
+      else
+         return std::make_unique< BasicSquare<0UL,padding> >( spec.size, Translate{} );
+   }, "manual_function_solution" );
+
+   // Misaligned storage is undefined behavior, tolerated by x86 only, hence this solution is only
+   // built for x86 and only runs if it is named by --filter (e.g. --filter=misaligned).
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+   suite.add_opt_in( "manual_function_misaligned_solution", "Manual function (misaligned)", []( const benchmark::ShapeSpec& spec ) -> manual_function_solution::Shapes::value_type
    {
       using namespace manual_function_solution;
 
-      rng.seed( seed );
+      constexpr size_t padding( alignof(std::max_align_t) );
+
+      if( spec.kind == benchmark::ShapeKind::circle )
+         return std::make_unique< BasicCircle<1UL,padding> >( spec.size, Translate{} );
+      else
+         return std::make_unique< BasicSquare<1UL,padding> >( spec.size, Translate{} );
+   }, "manual_function_solution" );
+#endif
+
+   suite.add( "vtable_function_solution", "Manual vtable function solution", []( const benchmark::ShapeSpec& spec ) -> vtable_function_solution::Shapes::value_type
+   {
+      using namespace vtable_function_solution;
+
+      if( spec.kind == benchmark::ShapeKind::circle )
+         return std::make_unique<Circle>( spec.size, Translate{} );
+      else
+         return std::make_unique<Square>( spec.size, Translate{} );
+   } );
+
+   suite.add( "function_ref_solution", "FunctionRef solution", []( const benchmark::ShapeSpec& spec ) -> function_ref_solution::Shapes::value_type
+   {
+      using namespace function_ref_solution;
+
+      if( spec.kind == benchmark::ShapeKind::circle )
+         return std::make_unique<Circle>( spec.size, strategy );
+      else
+         return std::make_unique<Square>( spec.size, strategy );
+   } );
+
+   suite.add( "type_partitioned_solution", "Type-partitioned solution", []( const benchmark::ShapeSpecs& specs )
+   {
+      using namespace type_partitioned_solution;
 
       Shapes shapes;
 
-      for( size_t i=0UL; i<N; ++i ) {
-         if( dist( rng ) < 0.5 )
-            shapes.push_back( std::make_unique<Circle>( dist( rng ), Translate{} ) );
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         if( spec.kind == benchmark::ShapeKind::circle )
+            shapes.push_back( Circle{ spec.size } );
          else
-            shapes.push_back( std::make_unique<Square>( dist( rng ), Translate{} ) );
+            shapes.push_back( Square{ spec.size } );
       }
 
-      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
-      start = std::chrono::high_resolution_clock::now();
+      return shapes;
+   } );
+
+   suite.add( "policy_solution", "Policy solution", []( const benchmark::ShapeSpecs& specs )
+   {
+      using namespace policy_solution;
+
+      Shapes shapes;
 
-      for( size_t s=0UL; s<steps; ++s ) {
-         translate( shapes, Vector3D{ dist( rng ), dist( rng ) } );
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         if( spec.kind == benchmark::ShapeKind::circle )
+            shapes.push_back( Circle<ConcreteTranslatePolicy>{ spec.size } );
+         else
+            shapes.push_back( Square<ConcreteTranslatePolicy>{ spec.size } );
       }
 
-      end = std::chrono::high_resolution_clock::now();
-      const std::chrono::duration<double> elapsedTime( end - start );
-      const double seconds( elapsedTime.count() );
+      return shapes;
+   } );
 
-      std::cout << " Manual function solution runtime : " << seconds << "s\n";
-   }
+   suite.add( "batch_strategy_solution", "Batch strategy solution", []( const benchmark::ShapeSpecs& specs )
+   {
+      using namespace batch_strategy_solution;
+
+      const std::shared_ptr<const TranslateStrategy> strategy( std::make_shared<ConcreteTranslateStrategy>() );
+
+      Shapes shapes;
+
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         if( spec.kind == benchmark::ShapeKind::circle )
+            shapes.push_back( Circle{ spec.size }, strategy );
+         else
+            shapes.push_back( Square{ spec.size }, strategy );
+      }
+
+      return shapes;
+   } );
+
+   suite.add( "soa_solution", std::string( "SoA solution (" ) + soa::kernel_name() + ")", []( const benchmark::ShapeSpecs& specs )
+   {
+      using namespace soa_solution;
+
+      Shapes shapes;
+      shapes.reserve( specs.size() );
+
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         shapes.push_back( static_cast<uint8_t>( spec.kind ), spec.size );
+      }
+
+      return shapes;
+   }, "soa" );
+
+   suite.add_generated( "classic_solution", []( const benchmark::ShapeSpec& spec, auto types )
+   {
+      using namespace classic_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      typename Shapes<K>::value_type shape;
+
+      shape_types::dispatch<K>( spec.type, [&]( auto type ){
+         constexpr size_t I( decltype(type)::value );
+         shape = std::make_unique< Primitive<I,K> >( spec.size
+                                                   , std::make_unique< ConcreteTranslateStrategy<K> >() );
+      } );
+
+      return shape;
+   } );
+
+   suite.add_generated( "flyweight_solution", []( const benchmark::ShapeSpec& spec, auto types )
+   {
+      using namespace flyweight_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      const TranslateStrategy<K>& strategy( flyweight_solution::registry< TranslateStrategy<K> >().template get< ConcreteTranslateStrategy<K> >() );
+
+      typename Shapes<K>::value_type shape;
+
+      shape_types::dispatch<K>( spec.type, [&]( auto type ){
+         constexpr size_t I( decltype(type)::value );
+         shape = std::make_unique< Primitive<I,K> >( spec.size, strategy );
+      } );
+
+      return shape;
+   } );
+
+   suite.add_generated( "std_function_solution", []( const benchmark::ShapeSpec& spec, auto types )
+   {
+      using namespace std_function_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      typename Shapes<K>::value_type shape;
+
+      shape_types::dispatch<K>( spec.type, [&]( auto type ){
+         constexpr size_t I( decltype(type)::value );
+         shape = std::make_unique< Primitive<I> >( spec.size, Translate{} );
+      } );
+
+      return shape;
+   } );
+
+   suite.add_generated( "manual_function_solution", []( const benchmark::ShapeSpec& spec, auto types )
+   {
+      using namespace manual_function_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      typename Shapes<K>::value_type shape;
+
+      shape_types::dispatch<K>( spec.type, [&]( auto type ){
+         constexpr size_t I( decltype(type)::value );
+         shape = std::make_unique< Primitive<I> >( spec.size, Translate{} );
+      } );
+
+      return shape;
+   } );
+
+   suite.add_generated( "vtable_function_solution", []( const benchmark::ShapeSpec& spec, auto types )
+   {
+      using namespace vtable_function_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      typename Shapes<K>::value_type shape;
+
+      shape_types::dispatch<K>( spec.type, [&]( auto type ){
+         constexpr size_t I( decltype(type)::value );
+         shape = std::make_unique< Primitive<I> >( spec.size, Translate{} );
+      } );
+
+      return shape;
+   } );
+
+   suite.add_generated( "function_ref_solution", []( const benchmark::ShapeSpec& spec, auto types )
+   {
+      using namespace function_ref_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      typename Shapes<K>::value_type shape;
+
+      shape_types::dispatch<K>( spec.type, [&]( auto type ){
+         constexpr size_t I( decltype(type)::value );
+         shape = std::make_unique< Primitive<I> >( spec.size, strategy );
+      } );
+
+      return shape;
+   } );
+
+   suite.add_generated( "type_partitioned_solution", []( const benchmark::ShapeSpecs& specs, auto types )
+   {
+      using namespace type_partitioned_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      Shapes<K> shapes;
+
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         shape_types::dispatch<K>( spec.type, [&]( auto type ){
+            constexpr size_t I( decltype(type)::value );
+            shapes.push_back( Primitive<I>{ spec.size } );
+         } );
+      }
+
+      return shapes;
+   } );
+
+   suite.add_generated( "policy_solution", []( const benchmark::ShapeSpecs& specs, auto types )
+   {
+      using namespace policy_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      Shapes<K> shapes;
+
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         shape_types::dispatch<K>( spec.type, [&]( auto type ){
+            constexpr size_t I( decltype(type)::value );
+            shapes.push_back( ConcretePrimitive<I>{ spec.size } );
+         } );
+      }
+
+      return shapes;
+   } );
+
+   suite.add_generated( "batch_strategy_solution", []( const benchmark::ShapeSpecs& specs, auto types )
+   {
+      using namespace batch_strategy_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      const std::shared_ptr<const TranslateStrategy<K>> strategy( std::make_shared< ConcreteTranslateStrategy<K> >() );
+
+      Shapes<K> shapes;
+
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         shape_types::dispatch<K>( spec.type, [&]( auto type ){
+            constexpr size_t I( decltype(type)::value );
+            shapes.push_back( Primitive<I>{ spec.size }, strategy );
+         } );
+      }
+
+      return shapes;
+   } );
+
+   // The generated variant stores all K types in the same soa::ShapeStore and has no code of its
+   // own, hence there is no generated namespace and its code size is not reported.
+   suite.add_generated( "soa_solution", []( const benchmark::ShapeSpecs& specs, auto )
+   {
+      using namespace soa_solution;
+
+      Shapes shapes;
+      shapes.reserve( specs.size() );
+
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         shapes.push_back( static_cast<uint8_t>( spec.type ), spec.size );
+      }
+
+      return shapes;
+   } );
 
-   return EXIT_SUCCESS;
+   return suite.run( argc, argv );
 }
 
@@ -0,0 +1,157 @@
+/**************************************************************************************************
+*
+* \file Vector3D.hpp
+* \brief C++ Training - Alternative memory layouts of Vector3D for the design pattern benchmarks
+*
+* Copyright (C) 2015-2020 Klaus Iglberger - All Rights Reserved
+*
+* This file is part of the C++ training by Klaus Iglberger. The file may only be used in the
+* context of the C++ training or with explicit agreement by Klaus Iglberger.
+*
+**************************************************************************************************/
+
+#ifndef VECTOR3D_HPP
+#define VECTOR3D_HPP
+
+#if defined(__SSE2__) || defined(__AVX__)
+#  include <immintrin.h>
+#endif
+
+
+namespace vector3d {
+
+   //**********************************************************************************************
+   // Three doubles without padding (24 bytes, 8-byte aligned). Inside of a Circle or Square the
+   // vector may straddle a cache line; it is added via an unaligned 128-bit operation for x/y plus
+   // a scalar z, also with AVX (masked 256-bit loads and stores are far slower than three adds).
+   struct Packed
+   {
+      static constexpr const char* layout = "packed";
+
+      double x{};
+      double y{};
+      double z{};
+   };
+
+   inline Packed operator+( const Packed& a, const Packed& b )
+   {
+      Packed r;
+#if defined(__SSE2__)
+      _mm_storeu_pd( &r.x, _mm_add_pd( _mm_loadu_pd( &a.x ), _mm_loadu_pd( &b.x ) ) );
+      r.z = a.z + b.z;
+#else
+      r.x = a.x + b.x;
+      r.y = a.y + b.y;
+      r.z = a.z + b.z;
+#endif
+      return r;
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Three doubles padded to 32 bytes and aligned to 32 bytes, i.e. one aligned 256-bit register
+   // (or two aligned 128-bit registers). The padding element w is always 0.
+   struct alignas(32) Padded
+   {
+      static constexpr const char* layout = "padded";
+
+      double x{};
+      double y{};
+      double z{};
+      double w{};
+   };
+
+   inline Padded operator+( const Padded& a, const Padded& b )
+   {
+      Padded r;
+#if defined(__AVX__)
+      _mm256_store_pd( &r.x, _mm256_add_pd( _mm256_load_pd( &a.x ), _mm256_load_pd( &b.x ) ) );
+#elif defined(__SSE2__)
+      _mm_store_pd( &r.x, _mm_add_pd( _mm_load_pd( &a.x ), _mm_load_pd( &b.x ) ) );
+      _mm_store_pd( &r.z, _mm_add_pd( _mm_load_pd( &a.z ), _mm_load_pd( &b.z ) ) );
+#else
+      r.x = a.x + b.x;
+      r.y = a.y + b.y;
+      r.z = a.z + b.z;
+#endif
+      return r;
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Three doubles aligned to a cache line (64 bytes). Every shape containing the vector is itself
+   // aligned to and padded to a multiple of a cache line, both in containers of values and on the
+   // heap, such that no two shapes share a cache line, i.e. the padded shape layout against false
+   // sharing between threads. A shape with a member in front of the center occupies two cache
+   // lines. The addition is the same as for Padded.
+   struct alignas(64) CacheLine
+   {
+      static constexpr const char* layout = "cacheline";
+
+      double x{};
+      double y{};
+      double z{};
+      double w{};
+   };
+
+   inline CacheLine operator+( const CacheLine& a, const CacheLine& b )
+   {
+      CacheLine r;
+#if defined(__AVX__)
+      _mm256_store_pd( &r.x, _mm256_add_pd( _mm256_load_pd( &a.x ), _mm256_load_pd( &b.x ) ) );
+#elif defined(__SSE2__)
+      _mm_store_pd( &r.x, _mm_add_pd( _mm_load_pd( &a.x ), _mm_load_pd( &b.x ) ) );
+      _mm_store_pd( &r.z, _mm_add_pd( _mm_load_pd( &a.z ), _mm_load_pd( &b.z ) ) );
+#else
+      r.x = a.x + b.x;
+      r.y = a.y + b.y;
+      r.z = a.z + b.z;
+#endif
+      return r;
+   }
+   //**********************************************************************************************
+
+
+   //**********************************************************************************************
+   // Three floats padded to 16 bytes and aligned to 16 bytes, i.e. one aligned 128-bit register.
+   // Halves the size of the vector at the cost of precision. The padding element w is always 0.
+   struct alignas(16) Float
+   {
+      static constexpr const char* layout = "float";
+
+      float x{};
+      float y{};
+      float z{};
+      float w{};
+   };
+
+   inline Float operator+( const Float& a, const Float& b )
+   {
+      Float r;
+#if defined(__SSE2__)
+      _mm_store_ps( &r.x, _mm_add_ps( _mm_load_ps( &a.x ), _mm_load_ps( &b.x ) ) );
+#else
+      r.x = a.x + b.x;
+      r.y = a.y + b.y;
+      r.z = a.z + b.z;
+#endif
+      return r;
+   }
+   //**********************************************************************************************
+
+} // namespace vector3d
+
+
+//*************************************************************************************************
+// The layout used by the benchmarks, selected at compile time via -DBENCHMARK_VECTOR3D=Packed,
+// Padded, CacheLine or Float (default: Packed).
+#ifndef BENCHMARK_VECTOR3D
+#  define BENCHMARK_VECTOR3D Packed
+#endif
+
+using Vector3D = vector3d::BENCHMARK_VECTOR3D;
+//*************************************************************************************************
+
+#endif
@@ -10,27 +10,18 @@
 *
 **************************************************************************************************/
 
-#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
-#include <random>
+#include <span>
 #include <variant>
 #include <vector>
 #include "mpark/variant.hpp"
-
-
-struct Vector3D
-{
-   double x{};
-   double y{};
-   double z{};
-};
-
-Vector3D operator+( const Vector3D& a, const Vector3D& b )
-{
-   return Vector3D{ a.x+b.x, a.y+b.y, a.z+b.z };
-}
+#include "Benchmark.hpp"
+#include "PolyCollection.hpp"
+#include "ShapeStore.hpp"
+#include "ShapeTypes.hpp"
+#include "Vector3D.hpp"
 
 
 namespace enum_solution {
@@ -95,7 +86,7 @@ namespace enum_solution {
 
    using Shapes = std::vector< std::unique_ptr<Shape> >;
 
-   void translate( Shapes& shapes, const Vector3D& v )
+   void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
    {
       for( const auto& s : shapes )
       {
@@ -111,6 +102,68 @@ namespace enum_solution {
       }
    }
 
+
+   // Generalization to K shape types. The switch is generated by shape_types::dispatch().
+   namespace generated {
+
+      struct Shape
+      {
+         Shape( size_t t )
+            : type( t )
+         {}
+
+         virtual ~Shape() {}
+
+         size_t type;
+      };
+
+
+      template< size_t I >
+      struct Primitive : public Shape
+      {
+         Primitive( double s )
+            : Shape( I )
+            , size( s )
+            , center()
+         {}
+
+         ~Primitive() {}
+
+         double size;
+         Vector3D center;
+      };
+
+      template< size_t I >
+      void translate( Primitive<I>& p, const Vector3D& v )
+      {
+         p.center = p.center + v;
+      }
+
+
+      template< size_t K >
+      struct Shapes : public std::vector< std::unique_ptr<Shape> >
+      {};
+
+      // The shapes are passed as Shapes<K> instead of std::span to provide K for the dispatch.
+      template< size_t K >
+      void translate( Shapes<K>& shapes, const Vector3D& v, size_t begin, size_t end )
+      {
+         for( const auto& s : std::span( shapes ).subspan( begin, end-begin ) )
+         {
+            shape_types::dispatch<K>( s->type, [&]( auto type ){
+               translate( static_cast<Primitive<decltype(type)::value>&>( *s.get() ), v );
+            } );
+         }
+      }
+
+      template< size_t K >
+      void translate( Shapes<K>& shapes, const Vector3D& v )
+      {
+         translate( shapes, v, 0UL, shapes.size() );
+      }
+
+   } // namespace generated
+
 } // namespace enum_solution
 
 
@@ -169,7 +222,7 @@ namespace object_oriented_solution {
 
    using Shapes = std::vector< std::unique_ptr<Shape> >;
 
-   void translate( Shapes& shapes, const Vector3D& v )
+   void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
    {
       for( const auto& s : shapes )
       {
@@ -177,6 +230,55 @@ namespace object_oriented_solution {
       }
    }
 
+
+   // Generalization to K shape types.
+   namespace generated {
+
+      struct Shape
+      {
+         Shape()
+         {}
+
+         virtual ~Shape() {}
+
+         virtual void translate( const Vector3D& v ) = 0;
+      };
+
+
+      template< size_t I >
+      struct Primitive : public Shape
+      {
+         Primitive( double s )
+            : Shape()
+            , size( s )
+            , center()
+         {}
+
+         ~Primitive() {}
+
+         void translate( const Vector3D& v ) override
+         {
+            center = center + v;
+         }
+
+         double size;
+         Vector3D center;
+      };
+
+
+      template< size_t K >
+      using Shapes = std::vector< std::unique_ptr<Shape> >;
+
+      void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
+      {
+         for( const auto& s : shapes )
+         {
+            s->translate( v );
+         }
+      }
+
+   } // namespace generated
+
 }
 
 
@@ -248,7 +350,7 @@ namespace visitor_solution {
 
    using Shapes = std::vector< std::unique_ptr<Shape> >;
 
-   void translate( Shapes const& shapes, const Vector3D& v )
+   void translate( std::span< std::unique_ptr<Shape> > shapes, const Vector3D& v )
    {
       for( auto const& shape : shapes )
       {
@@ -256,6 +358,102 @@ namespace visitor_solution {
       }
    }
 
+
+   // Generalization to K shape types. The Visitor with K visit() overloads is generated by
+   // shape_types::Chain, one slot per shape type.
+   namespace generated {
+
+      template< size_t I, size_t K >
+      struct Primitive;
+
+
+      struct VisitorRoot
+      {
+         virtual ~VisitorRoot() = default;
+
+         void visit() const = delete;
+      };
+
+      template< size_t K >
+      struct VisitSlots
+      {
+         template< size_t I, typename Base >
+         struct Slot : public Base
+         {
+            using Base::visit;
+            virtual void visit( Primitive<I,K>& ) const = 0;
+         };
+      };
+
+      template< size_t K >
+      using Visitor = shape_types::Chain_t< K, VisitSlots<K>::template Slot, VisitorRoot >;
+
+
+      template< size_t K >
+      struct Shape
+      {
+         Shape() = default;
+
+         virtual ~Shape() {}
+
+         virtual void accept( const Visitor<K>& v ) = 0;
+      };
+
+
+      template< size_t I, size_t K >
+      struct Primitive : public Shape<K>
+      {
+         Primitive( double s )
+            : Shape<K>{}
+            , size{ s }
+         {}
+
+         ~Primitive() {}
+
+         void accept( const Visitor<K>& v ) override { v.visit( *this ); }
+
+         double size{};
+         Vector3D center{};
+      };
+
+
+      template< size_t K >
+      struct TranslateRoot : public Visitor<K>
+      {
+         TranslateRoot( const Vector3D& vec ) : v{ vec } {}
+         Vector3D v{};
+      };
+
+      template< size_t K >
+      struct TranslateSlots
+      {
+         template< size_t I, typename Base >
+         struct Slot : public Base
+         {
+            using Base::Base;
+            using Base::visit;
+            void visit( Primitive<I,K>& p ) const override { p.center = p.center + this->v; }
+         };
+      };
+
+      template< size_t K >
+      using Translate = shape_types::Chain_t< K, TranslateSlots<K>::template Slot, TranslateRoot<K> >;
+
+
+      template< size_t K >
+      using Shapes = std::vector< std::unique_ptr< Shape<K> > >;
+
+      template< size_t K >
+      void translate( std::span< std::unique_ptr< Shape<K> > > shapes, const Vector3D& v )
+      {
+         for( auto const& shape : shapes )
+         {
+            shape->accept( Translate<K>{ v } );
+         }
+      }
+
+   } // namespace generated
+
 } // namespace visitor_solution
 
 
@@ -292,7 +490,7 @@ namespace std_variant_solution {
 
    using Shapes = std::vector<Shape>;
 
-   void translate( Shapes& shapes, const Vector3D& v )
+   void translate( std::span<Shape> shapes, const Vector3D& v )
    {
       for( auto& shape : shapes )
       {
@@ -300,6 +498,49 @@ namespace std_variant_solution {
       }
    }
 
+
+   // Generalization to K shape types, i.e. a std::variant with K alternatives.
+   namespace generated {
+
+      template< size_t I >
+      struct Primitive
+      {
+         double size{};
+         Vector3D center{};
+      };
+
+
+      template< size_t K >
+      using Shape = shape_types::VariantOf_t< K, std::variant, Primitive >;
+
+      struct Translate
+      {
+         template< size_t I >
+         void operator()( Primitive<I>& p ) const { p.center = p.center + v; }
+         Vector3D v{};
+      };
+
+      template< typename... Ts >
+      void translate( std::variant<Ts...>& s, const Vector3D& v )
+      {
+         std::visit( Translate{ v }, s );
+      }
+
+
+      template< size_t K >
+      using Shapes = std::vector< Shape<K> >;
+
+      template< typename... Ts >
+      void translate( std::span< std::variant<Ts...> > shapes, const Vector3D& v )
+      {
+         for( auto& shape : shapes )
+         {
+            translate( shape, v );
+         }
+      }
+
+   } // namespace generated
+
 } // namespace std_variant_solution
 
 
@@ -336,7 +577,7 @@ namespace mpark_variant_solution {
 
    using Shapes = std::vector<Shape>;
 
-   void translate( Shapes& shapes, const Vector3D& v )
+   void translate( std::span<Shape> shapes, const Vector3D& v )
    {
       for( auto& shape : shapes )
       {
@@ -344,160 +585,354 @@ namespace mpark_variant_solution {
       }
    }
 
-} // namespace mpark_variant_solution
 
+   // Generalization to K shape types, i.e. a mpark::variant with K alternatives.
+   namespace generated {
 
-int main()
-{
-   const size_t N    ( 100UL );
-   const size_t steps( 2500000UL );
+      template< size_t I >
+      struct Primitive
+      {
+         double size{};
+         Vector3D center{};
+      };
 
-   std::random_device rd{};
-   const unsigned int seed( rd() );
 
-   std::mt19937 rng{};
-   std::uniform_real_distribution<double> dist( 0.0, 1.0 );
+      template< size_t K >
+      using Shape = shape_types::VariantOf_t< K, mpark::variant, Primitive >;
 
-   {
-      using namespace enum_solution;
+      struct Translate
+      {
+         template< size_t I >
+         void operator()( Primitive<I>& p ) const { p.center = p.center + v; }
+         Vector3D v{};
+      };
+
+      template< typename... Ts >
+      void translate( mpark::variant<Ts...>& s, const Vector3D& v )
+      {
+         mpark::visit( Translate{ v }, s );
+      }
 
-      rng.seed( seed );
 
-      Shapes shapes;
+      template< size_t K >
+      using Shapes = std::vector< Shape<K> >;
 
-      for( size_t i=0UL; i<N; ++i ) {
-         if( dist( rng ) < 0.5 )
-            shapes.push_back( std::make_unique<Circle>( dist( rng ) ) );
-         else
-            shapes.push_back( std::make_unique<Square>( dist( rng ) ) );
+      template< typename... Ts >
+      void translate( std::span< mpark::variant<Ts...> > shapes, const Vector3D& v )
+      {
+         for( auto& shape : shapes )
+         {
+            translate( shape, v );
+         }
       }
 
-      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
-      start = std::chrono::high_resolution_clock::now();
+   } // namespace generated
 
-      for( size_t s=0UL; s<steps; ++s ) {
-         translate( shapes, Vector3D{ dist( rng ), dist( rng ) } );
-      }
+} // namespace mpark_variant_solution
 
-      end = std::chrono::high_resolution_clock::now();
-      const std::chrono::duration<double> elapsedTime( end - start );
-      const double seconds( elapsedTime.count() );
 
-      std::cout << "\n Enum solution runtime          : " << seconds << "s\n";
+namespace type_partitioned_solution {
+
+   struct Circle
+   {
+      double radius{};
+      Vector3D center{};
+   };
+
+   void translate( Circle& c, const Vector3D& v )
+   {
+      c.center = c.center + v;
    }
 
+
+   struct Square
    {
-      using namespace object_oriented_solution;
+      double side{};
+      Vector3D center{};
+   };
 
-      rng.seed( seed );
+   void translate( Square& s, const Vector3D& v )
+   {
+      s.center = s.center + v;
+   }
 
-      Shapes shapes;
 
-      for( size_t i=0UL; i<N; ++i ) {
-         if( dist( rng ) < 0.5 )
-            shapes.push_back( std::make_unique<Circle>( dist( rng ) ) );
-         else
-            shapes.push_back( std::make_unique<Square>( dist( rng ) ) );
+   using Shapes = poly::Collection<Circle,Square>;
+
+   void translate( Shapes& shapes, const Vector3D& v )
+   {
+      shapes.for_each( [&]( auto& shape ){ translate( shape, v ); } );
+   }
+
+   void translate( Shapes& shapes, const Vector3D& v, size_t begin, size_t end )
+   {
+      shapes.for_each( [&]( auto& shape ){ translate( shape, v ); }, begin, end );
+   }
+
+
+   // Generalization to K shape types, i.e. a collection with K segments.
+   namespace generated {
+
+      template< size_t I >
+      struct Primitive
+      {
+         double size{};
+         Vector3D center{};
+      };
+
+      template< size_t I >
+      void translate( Primitive<I>& p, const Vector3D& v )
+      {
+         p.center = p.center + v;
       }
 
-      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
-      start = std::chrono::high_resolution_clock::now();
 
-      for( size_t s=0UL; s<steps; ++s ) {
-         translate( shapes, Vector3D{ dist( rng ), dist( rng ) } );
+      template< size_t K >
+      using Shapes = shape_types::VariantOf_t< K, poly::Collection, Primitive >;
+
+      template< typename... Ts >
+      void translate( poly::Collection<Ts...>& shapes, const Vector3D& v )
+      {
+         shapes.for_each( [&]( auto& shape ){ translate( shape, v ); } );
+      }
+
+      template< typename... Ts >
+      void translate( poly::Collection<Ts...>& shapes, const Vector3D& v, size_t begin, size_t end )
+      {
+         shapes.for_each( [&]( auto& shape ){ translate( shape, v ); }, begin, end );
       }
 
-      end = std::chrono::high_resolution_clock::now();
-      const std::chrono::duration<double> elapsedTime( end - start );
-      const double seconds( elapsedTime.count() );
+   } // namespace generated
 
-      std::cout << " OO solution runtime            : " << seconds << "s\n";
-   }
+} // namespace type_partitioned_solution
+
+
+namespace soa_solution {
+
+   // The shapes are stored as a structure of arrays (see ShapeStore.hpp), such that a translation
+   // is a vectorized pass over the x, y and z arrays instead of a dispatch per shape. The shape
+   // type is only kept as data; the translation does not depend on it.
+   using Shapes = soa::ShapeStore;
+
+   using soa::translate;
+
+} // namespace soa_solution
+
+
+int main( int argc, char** argv )
+{
+   benchmark::Suite<Vector3D> suite( "Visitor_Benchmark" );
+
+   suite.add( "enum_solution", "Enum solution", []( const benchmark::ShapeSpec& spec ) -> enum_solution::Shapes::value_type
+   {
+      using namespace enum_solution;
+
+      if( spec.kind == benchmark::ShapeKind::circle )
+         return std::make_unique<Circle>( spec.size );
+      else
+         return std::make_unique<Square>( spec.size );
+   } );
 
+   suite.add( "object_oriented_solution", "OO solution", []( const benchmark::ShapeSpec& spec ) -> object_oriented_solution::Shapes::value_type
+   {
+      using namespace object_oriented_solution;
+
+      if( spec.kind == benchmark::ShapeKind::circle )
+         return std::make_unique<Circle>( spec.size );
+      else
+         return std::make_unique<Square>( spec.size );
+   } );
+
+   suite.add( "visitor_solution", "Visitor solution", []( const benchmark::ShapeSpec& spec ) -> visitor_solution::Shapes::value_type
    {
       using namespace visitor_solution;
 
-      rng.seed( seed );
+      if( spec.kind == benchmark::ShapeKind::circle )
+         return std::make_unique<Circle>( spec.size );
+      else
+         return std::make_unique<Square>( spec.size );
+   } );
+
+   suite.add( "std_variant_solution", "std::variant solution", []( const benchmark::ShapeSpecs& specs )
+   {
+      using namespace std_variant_solution;
 
       Shapes shapes;
 
-      for( size_t i=0UL; i<N; ++i ) {
-         if( dist( rng ) < 0.5 )
-            shapes.push_back( std::make_unique<Circle>( dist( rng ) ) );
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         if( spec.kind == benchmark::ShapeKind::circle )
+            shapes.push_back( Circle{ spec.size } );
          else
-            shapes.push_back( std::make_unique<Square>( dist( rng ) ) );
+            shapes.push_back( Square{ spec.size } );
       }
 
-      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
-      start = std::chrono::high_resolution_clock::now();
+      return shapes;
+   } );
 
-      for( size_t s=0UL; s<steps; ++s ) {
-         translate( shapes, Vector3D{ dist( rng ), dist( rng ) } );
-      }
+   suite.add( "mpark_variant_solution", "mpark::variant solution", []( const benchmark::ShapeSpecs& specs )
+   {
+      using namespace mpark_variant_solution;
 
-      end = std::chrono::high_resolution_clock::now();
-      const std::chrono::duration<double> elapsedTime( end - start );
-      const double seconds( elapsedTime.count() );
+      Shapes shapes;
 
-      std::cout << " Classic solution runtime       : " << seconds << "s\n";
-   }
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         if( spec.kind == benchmark::ShapeKind::circle )
+            shapes.push_back( Circle{ spec.size } );
+         else
+            shapes.push_back( Square{ spec.size } );
+      }
 
-   {
-      using namespace std_variant_solution;
+      return shapes;
+   } );
 
-      rng.seed( seed );
+   suite.add( "type_partitioned_solution", "Type-partitioned solution", []( const benchmark::ShapeSpecs& specs )
+   {
+      using namespace type_partitioned_solution;
 
       Shapes shapes;
 
-      for( size_t i=0UL; i<N; ++i ) {
-         if( dist( rng ) < 0.5 )
-            shapes.push_back( Circle{ dist( rng ) } );
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         if( spec.kind == benchmark::ShapeKind::circle )
+            shapes.push_back( Circle{ spec.size } );
          else
-            shapes.push_back( Square{ dist( rng ) } );
+            shapes.push_back( Square{ spec.size } );
       }
 
-      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
-      start = std::chrono::high_resolution_clock::now();
+      return shapes;
+   } );
+
+   suite.add( "soa_solution", std::string( "SoA solution (" ) + soa::kernel_name() + ")", []( const benchmark::ShapeSpecs& specs )
+   {
+      using namespace soa_solution;
+
+      Shapes shapes;
+      shapes.reserve( specs.size() );
 
-      for( size_t s=0UL; s<steps; ++s ) {
-         translate( shapes, Vector3D{ dist( rng ), dist( rng ) } );
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         shapes.push_back( static_cast<uint8_t>( spec.kind ), spec.size );
       }
 
-      end = std::chrono::high_resolution_clock::now();
-      const std::chrono::duration<double> elapsedTime( end - start );
-      const double seconds( elapsedTime.count() );
+      return shapes;
+   }, "soa" );
 
-      std::cout << " std::variant solution runtime  : " << seconds << "s\n";
-   }
+   suite.add_generated<enum_solution::generated::Shapes>( "enum_solution", []( const benchmark::ShapeSpec& spec, auto types )
+   {
+      using namespace enum_solution::generated;
 
+      constexpr size_t K( decltype(types)::value );
+
+      typename Shapes<K>::value_type shape;
+
+      shape_types::dispatch<K>( spec.type, [&]( auto type ){
+         constexpr size_t I( decltype(type)::value );
+         shape = std::make_unique< Primitive<I> >( spec.size );
+      } );
+
+      return shape;
+   } );
+
+   suite.add_generated( "object_oriented_solution", []( const benchmark::ShapeSpec& spec, auto types )
    {
-      using namespace mpark_variant_solution;
+      using namespace object_oriented_solution::generated;
 
-      rng.seed( seed );
+      constexpr size_t K( decltype(types)::value );
 
-      Shapes shapes;
+      typename Shapes<K>::value_type shape;
 
-      for( size_t i=0UL; i<N; ++i ) {
-         if( dist( rng ) < 0.5 )
-            shapes.push_back( Circle{ dist( rng ) } );
-         else
-            shapes.push_back( Square{ dist( rng ) } );
+      shape_types::dispatch<K>( spec.type, [&]( auto type ){
+         constexpr size_t I( decltype(type)::value );
+         shape = std::make_unique< Primitive<I> >( spec.size );
+      } );
+
+      return shape;
+   } );
+
+   suite.add_generated( "visitor_solution", []( const benchmark::ShapeSpec& spec, auto types )
+   {
+      using namespace visitor_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      typename Shapes<K>::value_type shape;
+
+      shape_types::dispatch<K>( spec.type, [&]( auto type ){
+         constexpr size_t I( decltype(type)::value );
+         shape = std::make_unique< Primitive<I,K> >( spec.size );
+      } );
+
+      return shape;
+   } );
+
+   suite.add_generated( "std_variant_solution", []( const benchmark::ShapeSpecs& specs, auto types )
+   {
+      using namespace std_variant_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      Shapes<K> shapes;
+
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         shape_types::dispatch<K>( spec.type, [&]( auto type ){
+            constexpr size_t I( decltype(type)::value );
+            shapes.push_back( Primitive<I>{ spec.size } );
+         } );
+      }
+
+      return shapes;
+   } );
+
+   suite.add_generated( "mpark_variant_solution", []( const benchmark::ShapeSpecs& specs, auto types )
+   {
+      using namespace mpark_variant_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      Shapes<K> shapes;
+
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         shape_types::dispatch<K>( spec.type, [&]( auto type ){
+            constexpr size_t I( decltype(type)::value );
+            shapes.push_back( Primitive<I>{ spec.size } );
+         } );
       }
 
-      std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
-      start = std::chrono::high_resolution_clock::now();
+      return shapes;
+   } );
+
+   suite.add_generated( "type_partitioned_solution", []( const benchmark::ShapeSpecs& specs, auto types )
+   {
+      using namespace type_partitioned_solution::generated;
+
+      constexpr size_t K( decltype(types)::value );
+
+      Shapes<K> shapes;
 
-      for( size_t s=0UL; s<steps; ++s ) {
-         translate( shapes, Vector3D{ dist( rng ), dist( rng ) } );
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         shape_types::dispatch<K>( spec.type, [&]( auto type ){
+            constexpr size_t I( decltype(type)::value );
+            shapes.push_back( Primitive<I>{ spec.size } );
+         } );
       }
 
-      end = std::chrono::high_resolution_clock::now();
-      const std::chrono::duration<double> elapsedTime( end - start );
-      const double seconds( elapsedTime.count() );
+      return shapes;
+   } );
 
-      std::cout << " mpark::variant solution runtime: " << seconds << "s\n\n";
-   }
+   // The generated variant stores all K types in the same soa::ShapeStore and has no code of its
+   // own, hence there is no generated namespace and its code size is not reported.
+   suite.add_generated( "soa_solution", []( const benchmark::ShapeSpecs& specs, auto )
+   {
+      using namespace soa_solution;
+
+      Shapes shapes;
+      shapes.reserve( specs.size() );
+
+      for( const benchmark::ShapeSpec& spec : specs ) {
+         shapes.push_back( static_cast<uint8_t>( spec.type ), spec.size );
+      }
+
+      return shapes;
+   } );
 
-   return EXIT_SUCCESS;
+   return suite.run( argc, argv );
 }
 